@@ -0,0 +1,32 @@
+/**
+ * @file Arduino.h
+ *
+ * @brief Minimal Arduino core replacement for the cycle benchmark.
+ *
+ * The benchmark image is linked without the Arduino core so that Timer0
+ * interrupts cannot disturb the measurements. The library only needs the
+ * millis() time base, which is provided by the benchmark itself and can be
+ * set to any value, including values close to the rollover point.
+ *
+ * @author boolscope
+ */
+#ifndef _BENCH_ARDUINO_H
+#define _BENCH_ARDUINO_H
+
+#include <avr/io.h>
+
+/**
+ * @brief Returns the simulated time in milliseconds.
+ *
+ * @return The value of the benchmark's simulated millisecond counter.
+ */
+unsigned long millis();
+
+/**
+ * @brief Returns the simulated time in microseconds.
+ *
+ * @return The value of the benchmark's simulated microsecond counter.
+ */
+unsigned long micros();
+
+#endif  // _BENCH_ARDUINO_H
@@ -0,0 +1,310 @@
+/**
+ * @file cycles.cpp
+ *
+ * @brief Cycle-accurate measurement of the AsyncDelay hot path.
+ *
+ * The image is built for the ATmega328p and executed in simavr (see the
+ * `bench` target of the Makefile). Timer1 runs without a prescaler, so
+ * every TCNT1 tick is exactly one CPU cycle. Each operation is measured
+ * ITERATIONS times with varying input values, the cost of the measurement
+ * itself is subtracted, and the best and worst case are printed to USART0
+ * as `bench: <operation> <best> <worst>` lines.
+ *
+ * @author boolscope
+ */
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <avr/sleep.h>
+#include <limits.h>
+#include <stdint.h>
+
+#include "AsyncDelay.h"
+#include "AsyncClock.h"
+#include "AsyncScheduler.h"
+#include "AsyncWatchdog.h"
+
+// Number of measurements per operation.
+#define ITERATIONS 64
+
+// Reads TCNT1 without letting the compiler move code across the read.
+#define CYCLES(out)                          \
+    do {                                     \
+        __asm__ __volatile__("" ::: "memory"); \
+        out = TCNT1;                         \
+        __asm__ __volatile__("" ::: "memory"); \
+    } while (0)
+
+/** @brief Simulated millisecond counter returned by millis(). */
+static volatile unsigned long benchMillis = 0;
+
+unsigned long millis() {
+    return benchMillis;
+}
+
+unsigned long micros() {
+    return benchMillis * 1000UL;
+}
+
+/** @brief Best and worst case of a single measured operation. */
+struct Result {
+    uint16_t best;
+    uint16_t worst;
+};
+
+/** @brief Cycles spent by an empty measurement, subtracted from results. */
+static uint16_t overhead = 0;
+
+static void uartInit() {
+    UBRR0H = 0;
+    UBRR0L = 16;  // 115200 baud at 16 MHz with U2X0
+    UCSR0A = _BV(U2X0);
+    UCSR0B = _BV(TXEN0);
+    UCSR0C = _BV(UCSZ01) | _BV(UCSZ00);
+}
+
+static void uartPut(char c) {
+    while (!(UCSR0A & _BV(UDRE0))) {
+    }
+    UDR0 = c;
+}
+
+static void uartPrint(const char *s) {
+    while (*s) {
+        uartPut(*s++);
+    }
+}
+
+static void uartPrint(uint16_t value) {
+    char buf[6];
+    uint8_t i = 0;
+    do {
+        buf[i++] = '0' + value % 10;
+        value /= 10;
+    } while (value != 0);
+
+    while (i > 0) {
+        uartPut(buf[--i]);
+    }
+}
+
+static void report(const char *name, const Result &result) {
+    uartPrint("bench: ");
+    uartPrint(name);
+    uartPut(' ');
+    uartPrint(result.best);
+    uartPut(' ');
+    uartPrint(result.worst);
+    uartPut('\n');
+}
+
+static void record(Result &result, uint16_t start, uint16_t stop) {
+    uint16_t cycles = stop - start - overhead;
+    if (cycles < result.best) {
+        result.best = cycles;
+    }
+
+    if (cycles > result.worst) {
+        result.worst = cycles;
+    }
+}
+
+static void calibrate() {
+    uint16_t start, stop;
+    uint16_t best = UINT16_MAX;
+    for (uint8_t i = 0; i < ITERATIONS; i++) {
+        CYCLES(start);
+        CYCLES(stop);
+        if ((uint16_t)(stop - start) < best) {
+            best = stop - start;
+        }
+    }
+
+    overhead = best;
+}
+
+static void benchGetDelta() {
+    AsyncDelay timer(1000);
+    Result result = {UINT16_MAX, 0};
+    uint16_t start, stop;
+
+    for (uint8_t i = 0; i < ITERATIONS; i++) {
+        benchMillis = 1000UL + i * 7919UL;
+        timer.resetTime();
+        benchMillis += i * 13UL;
+
+        CYCLES(start);
+        timer.getDelta();
+        CYCLES(stop);
+        record(result, start, stop);
+    }
+
+    report("getDelta", result);
+}
+
+static void benchGetDeltaRollover() {
+    AsyncDelay timer(1000);
+    Result result = {UINT16_MAX, 0};
+    uint16_t start, stop;
+
+    for (uint8_t i = 0; i < ITERATIONS; i++) {
+        // The timestamp is taken right before the millis() overflow and
+        // the delta is calculated right after it.
+        benchMillis = ULONG_MAX - i * 31UL;
+        timer.resetTime();
+        benchMillis = i * 17UL;
+
+        CYCLES(start);
+        timer.getDelta();
+        CYCLES(stop);
+        record(result, start, stop);
+    }
+
+    report("getDelta/rollover", result);
+}
+
+static void benchIsReadyIdle() {
+    AsyncDelay timer(1000);
+    Result result = {UINT16_MAX, 0};
+    uint16_t start, stop;
+
+    for (uint8_t i = 0; i < ITERATIONS; i++) {
+        benchMillis = 5000UL + i * 7919UL;
+        timer.resetTime();
+        benchMillis += i;
+
+        CYCLES(start);
+        timer.isReady();
+        CYCLES(stop);
+        record(result, start, stop);
+    }
+
+    report("isReady/idle", result);
+}
+
+static void benchIsReadyFire() {
+    AsyncDelay timer(1000);
+    Result result = {UINT16_MAX, 0};
+    uint16_t start, stop;
+
+    for (uint8_t i = 0; i < ITERATIONS; i++) {
+        benchMillis = 5000UL + i * 7919UL;
+        timer.resetTime();
+        benchMillis += 1000UL + i;
+
+        CYCLES(start);
+        timer.isReady();
+        CYCLES(stop);
+        record(result, start, stop);
+    }
+
+    report("isReady/fire", result);
+}
+
+static void benchIsDone() {
+    AsyncDelay timer(1000);
+    Result result = {UINT16_MAX, 0};
+    uint16_t start, stop;
+
+    for (uint8_t i = 0; i < ITERATIONS; i++) {
+        benchMillis = 5000UL + i * 7919UL;
+        timer.resetTime();
+        benchMillis += 1000UL + i;
+
+        CYCLES(start);
+        timer.isDone();
+        CYCLES(stop);
+        record(result, start, stop);
+    }
+
+    report("isDone/fire", result);
+}
+
+static void benchPoll() {
+    AsyncDelay timers[4] = {AsyncDelay(100), AsyncDelay(250), AsyncDelay(500),
+                            AsyncDelay(1000)};
+    AsyncScheduler scheduler;
+    Result idle = {UINT16_MAX, 0};
+    Result fire = {UINT16_MAX, 0};
+    uint16_t start, stop;
+
+    for (uint8_t t = 0; t < 4; t++) {
+        scheduler.add(timers[t]);
+    }
+
+    for (uint8_t i = 0; i < ITERATIONS; i++) {
+        benchMillis = 5000UL + i * 7919UL;
+        for (uint8_t t = 0; t < 4; t++) {
+            timers[t].resetTime();
+        }
+
+        // No timer is due.
+        benchMillis += 50;
+        CYCLES(start);
+        scheduler.poll();
+        CYCLES(stop);
+        record(idle, start, stop);
+
+        // Only the first timer is due.
+        benchMillis += 50 + i;
+        CYCLES(start);
+        scheduler.poll();
+        CYCLES(stop);
+        record(fire, start, stop);
+    }
+
+    report("poll/4-idle", idle);
+    report("poll/4-one-fires", fire);
+}
+
+static void benchKick() {
+    AsyncWatchdog watchdog(1000);
+    Result kick = {UINT16_MAX, 0};
+    Result reset = {UINT16_MAX, 0};
+    uint16_t start, stop;
+
+    for (uint8_t i = 0; i < ITERATIONS; i++) {
+        benchMillis = 5000UL + i * 7919UL;
+        AsyncClock::tick();
+
+        CYCLES(start);
+        watchdog.kick();
+        CYCLES(stop);
+        record(kick, start, stop);
+
+        // The same retrigger done with resetTime(), which reads millis().
+        CYCLES(start);
+        watchdog.resetTime();
+        CYCLES(stop);
+        record(reset, start, stop);
+    }
+
+    report("kick", kick);
+    report("resetTime", reset);
+}
+
+int main() {
+    uartInit();
+
+    // Timer1 in normal mode without prescaler: one tick per CPU cycle.
+    TCCR1A = 0;
+    TCCR1B = _BV(CS10);
+
+    calibrate();
+    benchGetDelta();
+    benchGetDeltaRollover();
+    benchIsReadyIdle();
+    benchIsReadyFire();
+    benchIsDone();
+    benchPoll();
+    benchKick();
+
+    // Wait for the last byte to leave the USART, then stop the simulation:
+    // simavr exits when the CPU sleeps with interrupts disabled.
+    while (!(UCSR0A & _BV(UDRE0))) {
+    }
+    cli();
+    sleep_enable();
+    sleep_cpu();
+
+    return 0;
+}
@@ -0,0 +1,30 @@
+#include "AsyncConsole.h"
+
+AsyncDelay blinkDelay(500);
+AsyncDelay reportDelay(2000);
+
+AsyncScheduler scheduler;
+AsyncConsole console(Serial, scheduler);
+
+void blink() {
+    digitalWrite(LED_BUILTIN, !digitalRead(LED_BUILTIN));
+}
+
+void report() {
+    Serial.println("type 'help' for commands");
+}
+
+void setup() {
+    Serial.begin(9600);
+    pinMode(LED_BUILTIN, OUTPUT);
+
+    blinkDelay.setCallback(blink);
+    reportDelay.setCallback(report);
+    scheduler.add(blinkDelay);
+    scheduler.add(reportDelay);
+}
+
+void loop() {
+    scheduler.poll();
+    console.poll();
+}
@@ -0,0 +1,150 @@
+/**
+ * @file energy.cpp
+ *
+ * @brief Simulates a timer configuration on the host and estimates its
+ * average current and battery life.
+ *
+ * The scheduler, the power manager and the energy model run unchanged
+ * against the simulated clock of the host shim. Every timer callback
+ * advances the clock by its configured cost, every sleep mode by the
+ * requested duration plus its wake latency, so an hour of device time is
+ * simulated in a fraction of a second.
+ *
+ * Edit the `timers`, `modes` and `currents` tables to model a device, then
+ * compare intervals and sleep settings by the reported numbers.
+ *
+ * Usage: `energy [hours] [capacity-mAh]`, defaults to 1 and 2000.
+ *
+ * @author boolscope
+ */
+#include <Arduino.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "AsyncEnergyModel.h"
+#include "AsyncPowerManager.h"
+#include "AsyncScheduler.h"
+#include "AsyncWakeStats.h"
+
+/**
+ * @struct SimTimer
+ * @brief A simulated timer: its interval, the cost of its callback and
+ * whether it may be deferred until the CPU is awake anyway.
+ */
+struct SimTimer {
+    const char *name;
+    unsigned long interval;  // ms
+    unsigned long cost;      // us
+    bool deferrable;
+    unsigned long maxDeferral;  // ms, 0 = unlimited
+};
+
+static const SimTimer timers[] = {
+    {"sensor", 1000, 2000, false, 0},
+    {"radio", 10000, 30000, false, 0},
+    {"led", 50, 40, true, 0},
+    {"watchdog", 4000, 20, true, 1000},
+};
+
+static const uint8_t TIMERS = sizeof(timers) / sizeof(timers[0]);
+
+// Active, idle, then one entry per sleep mode, in microamperes.
+static const unsigned long currents[] = {5000, 1500, 800, 5};
+
+static AsyncScheduler scheduler;
+static AsyncEnergyModel energy(scheduler, currents, 4);
+static AsyncWakeStats wakes(scheduler);
+static AsyncDelay delays[TIMERS];
+
+// The cost of the callbacks, indexed like the timers.
+template <uint8_t I>
+static void run() {
+    delayMicroseconds(timers[I].cost);
+}
+
+static CallbackFunction callbacks[] = {run<0>, run<1>, run<2>, run<3>};
+
+// Sleep modes advance the simulated clock and report to the model.
+static void sleepIdle(unsigned long us) {
+    wakes.recordSleep();
+    hostAdvanceClock(us + 10);
+    energy.addSleep(0, us);
+    wakes.recordWake();
+}
+
+static void sleepPowerDown(unsigned long us) {
+    wakes.recordSleep();
+    hostAdvanceClock(us + 6000);
+    energy.addSleep(1, us);
+    wakes.recordWake();
+}
+
+static const AsyncSleepMode modes[] = {
+    {10, 50, sleepIdle},
+    {6000, 20000, sleepPowerDown},
+};
+
+static AsyncPowerManager power(scheduler, modes, 2);
+
+/**
+ * @class StdoutPrint
+ * @brief Writes Print output to stdout.
+ */
+class StdoutPrint : public Print {
+public:
+    size_t write(uint8_t c) override {
+        return putchar(c) == EOF ? 0 : 1;
+    }
+};
+
+int main(int argc, char **argv) {
+    unsigned long hours = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1;
+    unsigned long capacity = argc > 2 ? strtoul(argv[2], nullptr, 10) : 2000;
+
+    hostSimulateClock();
+    for (uint8_t i = 0; i < TIMERS; i++) {
+        delays[i].setInterval(timers[i].interval);
+        delays[i].setCallback(callbacks[i]);
+        scheduler.add(delays[i]);
+        scheduler.setDeferrable(i, timers[i].deferrable,
+                                timers[i].maxDeferral);
+    }
+
+    // Every loop iteration outside callbacks and sleep costs 20 us.
+    unsigned long long end = hostClock() + hours * 3600000000ULL;
+    energy.update();
+    while (hostClock() < end) {
+        scheduler.poll();
+        energy.update();
+        if (power.sleep() == AsyncPowerManager::NONE) {
+            delayMicroseconds(20);
+        }
+    }
+
+    energy.update();
+
+    printf("simulated   %lu ms\n", energy.getTotalTime());
+    printf("active      %lu ms\n", energy.getTime(AsyncEnergyModel::ACTIVE));
+    printf("idle        %lu ms\n", energy.getTime(AsyncEnergyModel::IDLE));
+    for (uint8_t m = 0; m < 2; m++) {
+        printf("sleep %-5u %lu ms (%lu entries)\n", m,
+               energy.getTime(AsyncEnergyModel::SLEEP + m),
+               power.getEntries(m));
+    }
+
+    printf("average     %lu uA\n", energy.getAverageCurrent());
+    printf("battery     %lu h (%lu days) at %lu mAh\n",
+           energy.getBatteryLife(capacity),
+           energy.getBatteryLife(capacity) / 24, capacity);
+    printf("wakeups     %lu\n", energy.getWakeups());
+    for (uint8_t i = 0; i < TIMERS; i++) {
+        printf("  %-10s %lu\n", timers[i].name, energy.getWakeups(i));
+    }
+
+    // Slot i is timers[i]; names are not registered with the scheduler.
+    printf("\nwakeup sources\n");
+    StdoutPrint out;
+    wakes.report(out);
+
+    return 0;
+}
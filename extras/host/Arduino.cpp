@@ -0,0 +1,121 @@
+#include "Arduino.h"
+
+#include <stdio.h>
+#include <time.h>
+
+/**
+ * @brief Returns the monotonic time of the host in microseconds since the
+ * first call.
+ */
+static unsigned long long monotonicMicros() {
+    static unsigned long long origin = 0;
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    unsigned long long now =
+        (unsigned long long)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+    if (origin == 0) {
+        origin = now;
+    }
+
+    return now - origin;
+}
+
+// Set by hostSimulateClock(); the simulated time only moves when advanced.
+static bool simulated = false;
+static unsigned long long simulatedMicros = 0;
+
+void hostSimulateClock(unsigned long long start) {
+    simulated = true;
+    simulatedMicros = start;
+}
+
+void hostAdvanceClock(unsigned long long us) {
+    simulatedMicros += us;
+}
+
+unsigned long long hostClock() {
+    return simulated ? simulatedMicros : monotonicMicros();
+}
+
+unsigned long millis() {
+    return (unsigned long)(hostClock() / 1000);
+}
+
+unsigned long micros() {
+    return (unsigned long)hostClock();
+}
+
+void delay(unsigned long ms) {
+    if (simulated) {
+        simulatedMicros += (unsigned long long)ms * 1000;
+        return;
+    }
+
+    struct timespec ts;
+    ts.tv_sec = ms / 1000;
+    ts.tv_nsec = (long)(ms % 1000) * 1000000L;
+    nanosleep(&ts, nullptr);
+}
+
+void delayMicroseconds(unsigned int us) {
+    if (simulated) {
+        simulatedMicros += us;
+        return;
+    }
+
+    struct timespec ts;
+    ts.tv_sec = us / 1000000;
+    ts.tv_nsec = (long)(us % 1000000) * 1000L;
+    nanosleep(&ts, nullptr);
+}
+
+int analogRead(uint8_t pin) {
+    (void)pin;
+    return 0;
+}
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+    size_t n = 0;
+    while (n < size && this->write(buffer[n])) {
+        n++;
+    }
+
+    return n;
+}
+
+size_t Print::print(const char *s) {
+    return this->write((const uint8_t *)s, strlen(s));
+}
+
+size_t Print::print(const __FlashStringHelper *s) {
+    return this->print((const char *)s);
+}
+
+size_t Print::print(char c) {
+    return this->write((uint8_t)c);
+}
+
+size_t Print::print(unsigned long n) {
+    char buf[24];
+    snprintf(buf, sizeof(buf), "%lu", n);
+    return this->print(buf);
+}
+
+size_t Print::print(long n) {
+    char buf[24];
+    snprintf(buf, sizeof(buf), "%ld", n);
+    return this->print(buf);
+}
+
+size_t Print::print(unsigned int n) {
+    return this->print((unsigned long)n);
+}
+
+size_t Print::print(int n) {
+    return this->print((long)n);
+}
+
+size_t Print::println() {
+    return this->print("\r\n");
+}
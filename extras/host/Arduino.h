@@ -0,0 +1,132 @@
+/**
+ * @file Arduino.h
+ *
+ * @brief Minimal Arduino core replacement for building the library on a
+ * host (Linux) system.
+ *
+ * Only the parts of the Arduino API used by the library are provided. The
+ * time base is the monotonic clock of the host, counted from the first call,
+ * or a simulated clock (see hostSimulateClock()).
+ *
+ * @author boolscope
+ */
+#ifndef _HOST_ARDUINO_H
+#define _HOST_ARDUINO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Program memory is ordinary memory on the host.
+#define PROGMEM
+#define PSTR(s) (s)
+#define F(s) ((const __FlashStringHelper *)(s))
+#define memcpy_P memcpy
+#define strcmp_P strcmp
+#define strlen_P strlen
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_ptr(p) (*(void *const *)(p))
+
+class __FlashStringHelper;
+
+/**
+ * @class Print
+ * @brief Subset of the Arduino Print class.
+ */
+class Print {
+public:
+    virtual ~Print() = default;
+    virtual size_t write(uint8_t c) = 0;
+
+    size_t write(const uint8_t *buffer, size_t size);
+    size_t print(const char *s);
+    size_t print(const __FlashStringHelper *s);
+    size_t print(char c);
+    size_t print(unsigned long n);
+    size_t print(long n);
+    size_t print(unsigned int n);
+    size_t print(int n);
+    size_t println();
+
+    template <typename T>
+    size_t println(T value) {
+        size_t n = this->print(value);
+        return n + this->println();
+    }
+};
+
+/**
+ * @class Stream
+ * @brief Subset of the Arduino Stream class.
+ */
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+};
+
+/**
+ * @brief Returns the number of milliseconds since the program started.
+ *
+ * @return The elapsed time in milliseconds.
+ */
+unsigned long millis();
+
+/**
+ * @brief Returns the number of microseconds since the program started.
+ *
+ * @return The elapsed time in microseconds.
+ */
+unsigned long micros();
+
+/**
+ * @brief Blocks for the given number of milliseconds.
+ *
+ * @param[in] ms The delay time in milliseconds.
+ */
+void delay(unsigned long ms);
+
+/**
+ * @brief Blocks for the given number of microseconds.
+ *
+ * @param[in] us The delay time in microseconds.
+ */
+void delayMicroseconds(unsigned int us);
+
+/**
+ * @brief Switches millis() and micros() to a simulated clock.
+ *
+ * The simulated clock only moves through hostAdvanceClock(), delay() and
+ * delayMicroseconds(), which return immediately. This makes time-dependent
+ * policies testable deterministically and much faster than real time.
+ *
+ * @param[in] start The initial time in microseconds.
+ */
+void hostSimulateClock(unsigned long long start = 0);
+
+/**
+ * @brief Advances the simulated clock.
+ *
+ * @param[in] us The time to add in microseconds.
+ */
+void hostAdvanceClock(unsigned long long us);
+
+/**
+ * @brief Returns the current time without wrapping.
+ *
+ * @return The simulated or monotonic time in microseconds.
+ */
+unsigned long long hostClock();
+
+/**
+ * @brief Reads an analog input. The host has none, so this returns 0.
+ *
+ * @param[in] pin The analog pin.
+ *
+ * @return The raw conversion result.
+ */
+int analogRead(uint8_t pin);
+
+#endif  // _HOST_ARDUINO_H
@@ -0,0 +1,87 @@
+#!/usr/bin/env python3
+"""Generates the host-side map of timer name ids.
+
+Scans C/C++ sources and sketches for ASYNC_NAME("...") and prints one
+`id,name` line per name, using the same hash as asyncNameHash() in
+AsyncName.h (32-bit FNV-1a folded to 16 bits). Comments are skipped, so
+names in doc examples are not collected. The escapes of the literal are
+resolved and the hash is taken over the resulting bytes, like the compiler
+does with a UTF-8 source file. Collisions are reported on stderr and make
+the script exit with status 1.
+
+Usage: names.py [path ...] > names.csv
+"""
+
+import os
+import re
+import sys
+
+PATTERN = re.compile(r'ASYNC_NAME\(\s*"((?:[^"\\]|\\.)*)"\s*\)')
+# String and character literals are matched so that comment markers inside
+# them are kept; comments are matched to be blanked out.
+TOKENS = re.compile(r'"(?:[^"\\\n]|\\.)*"|\'(?:[^\'\\\n]|\\.)*\''
+                    r'|//[^\n]*|/\*.*?\*/', re.S)
+ESCAPE = re.compile(rb'\\(x[0-9a-fA-F]+|[0-7]{1,3}|.)', re.S)
+SIMPLE = {b'n': 10, b't': 9, b'r': 13, b'a': 7, b'b': 8, b'f': 12,
+          b'v': 11}
+EXTENSIONS = ('.c', '.cpp', '.h', '.hpp', '.ino')
+
+
+def strip_comments(text):
+    def blank(match):
+        token = match.group(0)
+        return ' ' if token.startswith('/') else token
+    return TOKENS.sub(blank, text)
+
+
+def unescape(literal):
+    def resolve(match):
+        esc = match.group(1)
+        if esc[:1] == b'x':
+            return bytes([int(esc[1:], 16) & 0xFF])
+        if esc[:1].isdigit():
+            return bytes([int(esc, 8) & 0xFF])
+        return bytes([SIMPLE.get(esc, esc[0])])
+    return ESCAPE.sub(resolve, literal.encode('utf-8', 'surrogateescape'))
+
+
+def name_hash(data):
+    h = 2166136261
+    for byte in data:
+        h = ((h ^ byte) * 16777619) & 0xFFFFFFFF
+    return ((h >> 16) ^ (h & 0xFFFF)) & 0xFFFF
+
+
+def sources(paths):
+    for path in paths:
+        if os.path.isfile(path):
+            yield path
+            continue
+        for root, _, files in os.walk(path):
+            for f in sorted(files):
+                if f.endswith(EXTENSIONS):
+                    yield os.path.join(root, f)
+
+
+def main(paths):
+    ids = {}
+    status = 0
+    for path in sources(paths or ['.']):
+        with open(path, encoding='utf-8', errors='surrogateescape') as f:
+            for literal in PATTERN.findall(strip_comments(f.read())):
+                raw = unescape(literal)
+                name = raw.decode('utf-8', errors='replace')
+                h = name_hash(raw)
+                if h in ids and ids[h] != name:
+                    print('collision: "%s" and "%s" both hash to 0x%04x'
+                          % (ids[h], name, h), file=sys.stderr)
+                    status = 1
+                ids.setdefault(h, name)
+
+    for h in sorted(ids):
+        print('0x%04x,%s' % (h, ids[h]))
+    return status
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,124 @@
+/**
+ * @file shmstat.cpp
+ *
+ * @brief Live viewer for statistics published by AsyncSharedStats.
+ *
+ * Maps the shared-memory segment read-only, takes a seqlock snapshot every
+ * period and prints per-timer fire rates, missed periods, lateness
+ * percentiles (from the histogram) and average callback time.
+ *
+ * Usage: `shmstat [name] [period-ms]`, defaults to `/asyncdelay` and 1000.
+ *
+ * @author boolscope
+ */
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "AsyncSharedStats.h"
+
+/**
+ * @brief Returns the upper bound of the histogram bin containing the given
+ * percentile of all fires.
+ */
+static unsigned long percentile(const AsyncSharedTimer &t, unsigned pct) {
+    unsigned long total = 0;
+    for (int b = 0; b < ASYNC_SHARED_BINS; b++) {
+        total += t.histogram[b];
+    }
+
+    if (total == 0) {
+        return 0;
+    }
+
+    unsigned long rank = (total * pct + 99) / 100;
+    unsigned long seen = 0;
+    for (int b = 0; b < ASYNC_SHARED_BINS; b++) {
+        seen += t.histogram[b];
+        if (seen >= rank) {
+            return b == 0 ? 0 : (1UL << b) - 1;
+        }
+    }
+
+    return t.maxLateness;
+}
+
+int main(int argc, char **argv) {
+    const char *name = argc > 1 ? argv[1] : "/asyncdelay";
+    unsigned long period = argc > 2 ? strtoul(argv[2], nullptr, 10) : 1000;
+
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        perror(name);
+        return 1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(AsyncSharedHeader)) {
+        fprintf(stderr, "%s: not an AsyncSharedStats segment\n", name);
+        return 1;
+    }
+
+    size_t size = st.st_size;
+    void *p = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+
+    const AsyncSharedHeader *segment = (const AsyncSharedHeader *)p;
+    unsigned char *current = (unsigned char *)malloc(size);
+    unsigned char *previous = (unsigned char *)calloc(1, size);
+    bool first = true;
+
+    while (true) {
+        if (!AsyncSharedStats::read(segment, current, size)) {
+            fprintf(stderr, "%s: not initialized or publisher stalled\n", name);
+            sleep(1);
+            continue;
+        }
+
+        const AsyncSharedHeader *now = (const AsyncSharedHeader *)current;
+        const AsyncSharedHeader *before = (const AsyncSharedHeader *)previous;
+        const AsyncSharedTimer *timers = (const AsyncSharedTimer *)(now + 1);
+        const AsyncSharedTimer *old = (const AsyncSharedTimer *)(before + 1);
+        double seconds = (now->publishedMicros - before->publishedMicros) / 1e6;
+
+        printf("%-4s %-6s %10s %10s %10s %8s %8s %8s %10s\n", "slot", "name",
+               "interval", "fires/s", "missed/s", "p50", "p99", "max",
+               "cb avg us");
+        for (uint32_t i = 0; i < now->capacity; i++) {
+            const AsyncSharedTimer &t = timers[i];
+            if (!t.active) {
+                continue;
+            }
+
+            double fires = 0, missed = 0;
+            if (!first && seconds > 0 && old[i].active &&
+                t.fires >= old[i].fires) {
+                fires = (t.fires - old[i].fires) / seconds;
+                missed = (t.missed - old[i].missed) / seconds;
+            }
+
+            printf("%-4u %04lx   %10lu %10.2f %10.2f %8lu %8lu %8lu %10.1f\n",
+                   i, (unsigned long)t.name, (unsigned long)t.interval, fires,
+                   missed, percentile(t, 50), percentile(t, 99),
+                   (unsigned long)t.maxLateness,
+                   t.fires ? (double)t.callbackTime / t.fires : 0.0);
+        }
+
+        printf("\n");
+        fflush(stdout);
+
+        unsigned char *swap = previous;
+        previous = current;
+        current = swap;
+        first = false;
+
+        usleep(period * 1000);
+    }
+}
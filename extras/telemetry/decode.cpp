@@ -0,0 +1,256 @@
+/**
+ * @file decode.cpp
+ *
+ * @brief Host-side decoder for AsyncTelemetry frames.
+ *
+ * Reads a raw byte stream (e.g. a capture of the serial port) from a file or
+ * standard input, resynchronizes on the SYNC byte, validates every frame and
+ * prints the reconstructed absolute counters as CSV:
+ *
+ * @code
+ * sequence,slot,name,fires,missed,max_lateness_ms,callback_us
+ * @endcode
+ *
+ * Timer names are restored from the map written by `make names` (lines of
+ * `id,name`); ids missing from the map are printed as `#<hex id>`.
+ *
+ * Frames that arrive after a sequence gap are dropped until the next key
+ * frame, because their deltas refer to a frame the decoder has not seen.
+ *
+ * Usage: `decode [-n names.csv] [capture.bin] > stats.csv`
+ *
+ * @author boolscope
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "AsyncTelemetry.h"
+
+// The largest length a two-byte varint can carry.
+#define MAX_LENGTH 16383
+
+// The largest frame: SYNC, two length bytes, the payload and the checksum.
+#define MAX_FRAME (MAX_LENGTH + 4)
+
+// Timer names indexed by name id, loaded from the names map.
+static char *names[65536];
+
+// Absolute counter values reconstructed per slot.
+static uint32_t counters[256][AsyncTelemetry::COUNTERS];
+
+// The name id of each slot, sent in key frames only.
+static uint32_t slotNames[256];
+
+// Whether the decoder holds a valid state to apply deltas to.
+static bool synced = false;
+
+// The sequence number expected in the next frame.
+static uint8_t expected = 0;
+
+// Input bytes not consumed yet, in [begin, end).
+static uint8_t buffer[MAX_FRAME];
+static size_t begin = 0;
+static size_t end = 0;
+
+// Makes at least `need` bytes available at `buffer + begin`. Reads only the
+// missing bytes, so a live stream is decoded as it arrives.
+static bool fill(FILE *in, size_t need) {
+    if (end - begin >= need) {
+        return true;
+    }
+
+    memmove(buffer, buffer + begin, end - begin);
+    end -= begin;
+    begin = 0;
+
+    while (end < need) {
+        size_t got = fread(buffer + end, 1, need - end, in);
+        if (got == 0) {
+            return false;
+        }
+
+        end += got;
+    }
+
+    return true;
+}
+
+static void loadNames(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (f == nullptr) {
+        perror(path);
+        return;
+    }
+
+    char line[256];
+    while (fgets(line, sizeof(line), f) != nullptr) {
+        char *comma = strchr(line, ',');
+        if (comma == nullptr) {
+            continue;
+        }
+
+        *comma++ = '\0';
+        comma[strcspn(comma, "\r\n")] = '\0';
+        unsigned long id = strtoul(line, nullptr, 0);
+        if (id < 65536) {
+            free(names[id]);
+            names[id] = strdup(comma);
+        }
+    }
+
+    fclose(f);
+}
+
+static void printName(uint32_t id) {
+    if (id < 65536 && names[id] != nullptr) {
+        printf("%s", names[id]);
+    } else {
+        printf("#%04lx", (unsigned long)id);
+    }
+}
+
+static void decodeFrame(const uint8_t *payload, size_t length) {
+    if (length < 3) {
+        return;
+    }
+
+    uint8_t flags = payload[0];
+    uint8_t sequence = payload[1];
+    uint8_t count = payload[2];
+    bool key = (flags & AsyncTelemetry::FLAG_KEY_FRAME) != 0;
+
+    if ((flags & 0x0F) != AsyncTelemetry::VERSION) {
+        fprintf(stderr, "frame %u: unsupported version %u\n", sequence,
+                flags & 0x0F);
+        return;
+    }
+
+    if (!key && (!synced || sequence != expected)) {
+        fprintf(stderr, "frame %u: waiting for a key frame\n", sequence);
+        synced = false;
+        return;
+    }
+
+    // Decode into a copy first so a malformed frame leaves the state intact
+    // and prints nothing.
+    static uint32_t next[256][AsyncTelemetry::COUNTERS];
+    static uint32_t nextNames[256];
+    uint8_t slots[256];
+    memcpy(next, counters, sizeof(next));
+    memcpy(nextNames, slotNames, sizeof(nextNames));
+
+    size_t n = 3;
+    for (uint8_t t = 0; t < count; t++) {
+        if (n >= length) {
+            fprintf(stderr, "frame %u: truncated\n", sequence);
+            return;
+        }
+
+        uint8_t slot = payload[n++];
+        size_t used;
+        if (key) {
+            used = AsyncTelemetry::readVarint(payload + n, length - n,
+                                              &nextNames[slot]);
+            if (used == 0) {
+                fprintf(stderr, "frame %u: bad varint\n", sequence);
+                return;
+            }
+
+            n += used;
+        }
+
+        for (uint8_t c = 0; c < AsyncTelemetry::COUNTERS; c++) {
+            uint32_t value;
+            used = AsyncTelemetry::readVarint(payload + n, length - n, &value);
+            if (used == 0) {
+                fprintf(stderr, "frame %u: bad varint\n", sequence);
+                return;
+            }
+
+            n += used;
+            uint32_t delta = (uint32_t)AsyncTelemetry::unzigzag(value);
+            next[slot][c] = key ? delta : next[slot][c] + delta;
+        }
+
+        slots[t] = slot;
+    }
+
+    for (uint8_t t = 0; t < count; t++) {
+        uint8_t slot = slots[t];
+        printf("%u,%u,", sequence, slot);
+        printName(nextNames[slot]);
+        printf(",%lu,%lu,%lu,%lu\n",
+               (unsigned long)next[slot][0], (unsigned long)next[slot][1],
+               (unsigned long)next[slot][2], (unsigned long)next[slot][3]);
+    }
+
+    memcpy(counters, next, sizeof(counters));
+    memcpy(slotNames, nextNames, sizeof(slotNames));
+    synced = true;
+    expected = sequence + 1;
+}
+
+int main(int argc, char **argv) {
+    int arg = 1;
+    if (argc > arg + 1 && strcmp(argv[arg], "-n") == 0) {
+        loadNames(argv[arg + 1]);
+        arg += 2;
+    }
+
+    FILE *in = argc > arg ? fopen(argv[arg], "rb") : stdin;
+    if (in == nullptr) {
+        perror(argv[arg]);
+        return 1;
+    }
+
+    printf("sequence,slot,name,fires,missed,max_lateness_ms,callback_us\n");
+
+    // A rejected frame only consumes its SYNC byte, so a corrupted length
+    // cannot swallow the valid frames behind it, not even at the end of the
+    // input.
+    while (fill(in, 1)) {
+        if (buffer[begin] != AsyncTelemetry::SYNC) {
+            begin++;
+            continue;
+        }
+
+        if (!fill(in, 3)) {
+            begin++;
+            continue;
+        }
+
+        uint32_t length;
+        if (AsyncTelemetry::readVarint(buffer + begin + 1, 2, &length) != 2 ||
+            length > MAX_LENGTH) {
+            begin++;
+            continue;
+        }
+
+        if (!fill(in, length + 4)) {
+            begin++;
+            continue;
+        }
+
+        const uint8_t *payload = buffer + begin + 3;
+        uint8_t checksum = 0;
+        for (uint32_t i = 0; i < length; i++) {
+            checksum ^= payload[i];
+        }
+
+        if (checksum != payload[length]) {
+            fprintf(stderr, "checksum mismatch, resynchronizing\n");
+            begin++;
+            continue;
+        }
+
+        decodeFrame(payload, length);
+        begin += length + 4;
+    }
+
+    if (in != stdin) {
+        fclose(in);
+    }
+
+    return 0;
+}
@@ -0,0 +1,238 @@
+#include "AsyncAccounting.h"
+
+#include <Arduino.h>
+
+#include "AsyncClock.h"
+
+/**
+ * @brief Constructs a new AsyncAccounting object.
+ *
+ * All slots start untagged and all budgets at 100%.
+ *
+ * @param[in] scheduler The scheduler whose timers are accounted.
+ * @param[in] window The window in milliseconds.
+ */
+AsyncAccounting::AsyncAccounting(AsyncScheduler &scheduler,
+                                 unsigned long window)
+    : scheduler(scheduler), window(window == 0 ? 1 : window) {
+    for (unsigned char i = 0; i < AsyncScheduler::CAPACITY; i++) {
+        this->owners[i] = NONE;
+    }
+}
+
+/**
+ * @brief Tags a registered timer with a subsystem.
+ *
+ * A slot that is moved out of a throttled subsystem is released.
+ *
+ * @param[in] timer The timer, registered with the scheduler.
+ * @param[in] subsystem The subsystem id, or NONE.
+ *
+ * @return `true` if the timer was tagged, `false` if it is not registered
+ * or the id is out of range.
+ */
+bool AsyncAccounting::setSubsystem(AsyncDelay &timer, uint8_t subsystem) {
+    int index = this->scheduler.indexOf(timer);
+    if (index < 0 || (subsystem != NONE && subsystem >= SUBSYSTEMS)) {
+        return false;
+    }
+
+    this->sync(index);
+
+    // Only a slot that was or will be tagged is suspended or released, so
+    // an untagged slot keeps whatever state others gave it.
+    if (this->owners[index] == NONE && subsystem == NONE) {
+        return true;
+    }
+
+    bool throttled = subsystem != NONE &&
+                     this->subsystems[subsystem].over &&
+                     this->subsystems[subsystem].throttle;
+    this->owners[index] = subsystem;
+    this->scheduler.setSuspended(index, throttled);
+    return true;
+}
+
+/**
+ * @brief Sets the CPU budget of a subsystem.
+ *
+ * @param[in] subsystem The subsystem id.
+ * @param[in] budget The allowed share in percent.
+ * @param[in] throttle `true` to suspend the subsystem while it is over
+ * budget.
+ */
+void AsyncAccounting::setBudget(uint8_t subsystem, uint8_t budget,
+                                bool throttle) {
+    Subsystem &s = this->subsystems[subsystem];
+    s.budget = budget > 100 ? 100 : budget;
+    s.throttle = throttle;
+    this->suspend(subsystem, s.over && s.throttle);
+}
+
+/**
+ * @brief Sets the function called when a subsystem goes over budget.
+ *
+ * @param[in] fn The function, or nullptr.
+ */
+void AsyncAccounting::setOverBudgetCallback(OverBudgetFunction fn) {
+    this->overBudgetFunction = fn;
+}
+
+/**
+ * @brief Accounts the window if it has ended.
+ *
+ * @return `true` if a window was accounted.
+ */
+bool AsyncAccounting::update() {
+    return this->update(AsyncClock::read());
+}
+
+/**
+ * @brief Accounts the window if it has ended at the given time.
+ *
+ * The time of a slot is the growth of its AsyncTimerStats::callbackTime
+ * since the previous window, modulo 2^32 so a wrapping counter is still
+ * measured correctly. After resetStats() or a reused slot the counter
+ * starts again from zero. The shares are relative to the measured length of
+ * the window, so a late update() does not inflate them.
+ *
+ * @param[in] now The current time in milliseconds.
+ *
+ * @return `true` if a window was accounted.
+ */
+bool AsyncAccounting::update(unsigned long now) {
+    unsigned long elapsed = this->window.getDelta(now);
+    if (!this->window.isReady(now)) {
+        return false;
+    }
+
+    for (uint8_t id = 0; id < SUBSYSTEMS; id++) {
+        this->subsystems[id].time = 0;
+    }
+
+    uint8_t generation = this->scheduler.getStatsGeneration();
+    bool reset = generation != this->statsGeneration;
+    this->statsGeneration = generation;
+
+    for (unsigned char i = 0; i < AsyncScheduler::CAPACITY; i++) {
+        this->sync(i);
+        if (reset) {
+            this->callbackTimes[i] = 0;
+        }
+
+        unsigned long time = this->scheduler.getStats(i).callbackTime;
+        unsigned long delta = time - this->callbackTimes[i];
+        this->callbackTimes[i] = time;
+
+        if (this->owners[i] != NONE &&
+            this->scheduler.getTimer(i) != nullptr) {
+            this->subsystems[this->owners[i]].time += delta;
+        }
+    }
+
+    unsigned long long length = (unsigned long long)elapsed * 1000;
+    if (length == 0) {
+        length = 1;
+    }
+
+    for (uint8_t id = 0; id < SUBSYSTEMS; id++) {
+        Subsystem &s = this->subsystems[id];
+        unsigned long long percent =
+            (unsigned long long)s.time * 100 / length;
+        s.share = percent > 100 ? 100 : (uint8_t)percent;
+
+        // The average is kept in 1/16 percent.
+        long error = (long)s.share * 16 - (long)s.average;
+        s.average = (uint16_t)((long)s.average + error / 4);
+
+        bool over = s.average > (uint16_t)s.budget * 16;
+        if (over && !s.over && this->overBudgetFunction != nullptr) {
+            this->overBudgetFunction(id, s.share);
+        }
+
+        if (over != s.over) {
+            s.over = over;
+            this->suspend(id, over && s.throttle);
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Retrieves the share of a subsystem in the last window.
+ *
+ * @param[in] subsystem The subsystem id.
+ *
+ * @return The share in percent.
+ */
+uint8_t AsyncAccounting::getShare(uint8_t subsystem) {
+    return this->subsystems[subsystem].share;
+}
+
+/**
+ * @brief Retrieves the smoothed share of a subsystem.
+ *
+ * @param[in] subsystem The subsystem id.
+ *
+ * @return The average share in percent, rounded.
+ */
+uint8_t AsyncAccounting::getAverage(uint8_t subsystem) {
+    return (this->subsystems[subsystem].average + 8) / 16;
+}
+
+/**
+ * @brief Retrieves the callback time of a subsystem in the last window.
+ *
+ * @param[in] subsystem The subsystem id.
+ *
+ * @return The time in microseconds.
+ */
+unsigned long AsyncAccounting::getTime(uint8_t subsystem) {
+    return this->subsystems[subsystem].time;
+}
+
+/**
+ * @brief Checks if a subsystem is over its budget.
+ *
+ * @param[in] subsystem The subsystem id.
+ *
+ * @return `true` while the average share exceeds the budget.
+ */
+bool AsyncAccounting::isOverBudget(uint8_t subsystem) {
+    return this->subsystems[subsystem].over;
+}
+
+/**
+ * @brief Drops the state of a slot that add() has reused.
+ *
+ * The tag belonged to the previous timer, and the new timer's statistics
+ * start from zero. add() has already released the slot.
+ *
+ * @param[in] index The slot index.
+ */
+void AsyncAccounting::sync(unsigned char index) {
+    uint8_t generation = this->scheduler.getGeneration(index);
+    if (generation == this->generations[index]) {
+        return;
+    }
+
+    this->generations[index] = generation;
+    this->owners[index] = NONE;
+    this->callbackTimes[index] = 0;
+}
+
+/**
+ * @brief Suspends or releases all slots of a subsystem.
+ *
+ * @param[in] subsystem The subsystem id.
+ * @param[in] suspend `true` to suspend, `false` to release.
+ */
+void AsyncAccounting::suspend(uint8_t subsystem, bool suspend) {
+    for (unsigned char i = 0; i < AsyncScheduler::CAPACITY; i++) {
+        this->sync(i);
+        if (this->owners[i] == subsystem) {
+            this->scheduler.setSuspended(i, suspend);
+        }
+    }
+}
@@ -0,0 +1,200 @@
+/**
+ * @file AsyncAccounting.h
+ *
+ * @brief Provides per-subsystem CPU accounting with budget enforcement for
+ * the timers of an AsyncScheduler.
+ *
+ * @author boolscope
+ */
+#ifndef _ASYNC_ACCOUNTING_H
+#define _ASYNC_ACCOUNTING_H
+
+#include <stdint.h>
+
+#include "AsyncDelay.h"
+#include "AsyncScheduler.h"
+
+/**
+ * @brief The maximum number of subsystems.
+ *
+ * Define it before including this header to change it.
+ */
+#ifndef ASYNC_SUBSYSTEMS
+#define ASYNC_SUBSYSTEMS 4
+#endif
+
+/**
+ * @class AsyncAccounting
+ * @brief Attributes callback time to subsystems and enforces CPU shares.
+ *
+ * Every timer of the scheduler can be tagged with a subsystem id (comms,
+ * sensing, UI, ...). Once per window the growth of each slot's callback
+ * time is added to its subsystem, which gives the share of the window the
+ * subsystem used. The shares are smoothed over windows with an
+ * exponentially weighted moving average (weight 1/4), and the average is
+ * compared with the subsystem's budget.
+ *
+ * A subsystem over budget is flagged: isOverBudget() returns true and the
+ * callback, if set, is invoked once when the subsystem goes over. With
+ * throttling enabled, the slots of the subsystem are also suspended in the
+ * scheduler until the average is back within budget, which duty-cycles the
+ * subsystem down to its share.
+ *
+ * @code
+ * enum { COMMS, SENSING, UI };
+ * AsyncAccounting accounting(scheduler, 1000);
+ *
+ * void setup() {
+ *   accounting.setSubsystem(radioPoll, COMMS);
+ *   accounting.setSubsystem(display, UI);
+ *   accounting.setBudget(UI, 10, true);  // at most 10%, throttled
+ * }
+ *
+ * void loop() {
+ *   scheduler.poll();
+ *   accounting.update();
+ * }
+ * @endcode
+ */
+class AsyncAccounting {
+public:
+    /** @brief Called when a subsystem goes over its budget. */
+    typedef void (*OverBudgetFunction)(uint8_t subsystem, uint8_t share);
+
+    // Marks a slot that belongs to no subsystem.
+    static const uint8_t NONE = 0xFF;
+
+    // The number of subsystems.
+    static const uint8_t SUBSYSTEMS = ASYNC_SUBSYSTEMS;
+
+private:
+    /**
+     * @struct Subsystem
+     * @brief The budget and the measured shares of a subsystem.
+     */
+    struct Subsystem {
+        uint8_t budget = 100;
+        bool throttle = false;
+        bool over = false;
+        uint8_t share = 0;
+        uint16_t average = 0;
+        unsigned long time = 0;
+    };
+
+    /** @brief The scheduler whose timers are accounted. */
+    AsyncScheduler &scheduler;
+
+    /** @brief The subsystem of each slot, NONE if untagged. */
+    uint8_t owners[AsyncScheduler::CAPACITY];
+
+    /** @brief The callback time of each slot at the start of the window. */
+    unsigned long callbackTimes[AsyncScheduler::CAPACITY] = {};
+
+    /** @brief The scheduler generation each slot's state belongs to. */
+    uint8_t generations[AsyncScheduler::CAPACITY] = {};
+
+    /** @brief The scheduler statistics generation of `callbackTimes`. */
+    uint8_t statsGeneration = 0;
+
+    /** @brief The subsystems. */
+    Subsystem subsystems[ASYNC_SUBSYSTEMS];
+
+    /** @brief Measures the window. */
+    AsyncDelay window;
+
+    /** @brief Called when a subsystem goes over budget, may be nullptr. */
+    OverBudgetFunction overBudgetFunction = nullptr;
+
+    /** @brief Drops the state of a slot that add() has reused. */
+    void sync(unsigned char index);
+
+    /** @brief Suspends or releases all slots of a subsystem. */
+    void suspend(uint8_t subsystem, bool suspend);
+
+public:
+    /** @brief Constructs a new AsyncAccounting object.
+     *
+     * @param[in] scheduler The scheduler whose timers are accounted.
+     * @param[in] window The window in milliseconds. Defaults to 1000.
+     */
+    AsyncAccounting(AsyncScheduler &scheduler, unsigned long window = 1000);
+
+    /** @brief Tags a registered timer with a subsystem.
+     *
+     * @param[in] timer The timer, registered with the scheduler.
+     * @param[in] subsystem The subsystem id, or NONE to untag the timer.
+     *
+     * @retval true if the timer was tagged.
+     * @retval false if it is not registered or the id is out of range.
+     */
+    bool setSubsystem(AsyncDelay &timer, uint8_t subsystem);
+
+    /** @brief Sets the CPU budget of a subsystem.
+     *
+     * @param[in] subsystem The subsystem id.
+     * @param[in] budget The allowed share in percent. Defaults to 100.
+     * @param[in] throttle True to suspend the subsystem while it is over
+     * budget, false to only flag it.
+     *
+     * @return void
+     */
+    void setBudget(uint8_t subsystem, uint8_t budget, bool throttle = false);
+
+    /** @brief Sets the function called when a subsystem goes over budget.
+     *
+     * @param[in] fn The function, or nullptr.
+     *
+     * @return void
+     */
+    void setOverBudgetCallback(OverBudgetFunction fn);
+
+    /** @brief Accounts the window if it has ended.
+     *
+     * @retval true if a window was accounted.
+     * @retval false otherwise.
+     */
+    bool update();
+
+    /** @brief Accounts the window if it has ended at the given time.
+     *
+     * @param[in] now The current time in milliseconds.
+     *
+     * @retval true if a window was accounted.
+     * @retval false otherwise.
+     */
+    bool update(unsigned long now);
+
+    /** @brief Retrieves the share of a subsystem in the last window.
+     *
+     * @param[in] subsystem The subsystem id.
+     *
+     * @return The share in percent.
+     */
+    uint8_t getShare(uint8_t subsystem);
+
+    /** @brief Retrieves the smoothed share of a subsystem.
+     *
+     * @param[in] subsystem The subsystem id.
+     *
+     * @return The average share in percent.
+     */
+    uint8_t getAverage(uint8_t subsystem);
+
+    /** @brief Retrieves the callback time of a subsystem in the last window.
+     *
+     * @param[in] subsystem The subsystem id.
+     *
+     * @return The time in microseconds.
+     */
+    unsigned long getTime(uint8_t subsystem);
+
+    /** @brief Checks if a subsystem is over its budget.
+     *
+     * @param[in] subsystem The subsystem id.
+     *
+     * @return True while the average share exceeds the budget.
+     */
+    bool isOverBudget(uint8_t subsystem);
+};
+
+#endif  // _ASYNC_ACCOUNTING_H
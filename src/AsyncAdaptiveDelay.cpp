@@ -0,0 +1,147 @@
+#include "AsyncAdaptiveDelay.h"
+
+#include <Arduino.h>
+
+#include "AsyncClock.h"
+
+/**
+ * @brief Constructs a new AsyncAdaptiveDelay object.
+ *
+ * @param[in] minInterval The shortest interval in milliseconds.
+ * @param[in] maxInterval The longest interval in milliseconds.
+ * @param[in] threshold The activity at which the interval is shortened.
+ */
+AsyncAdaptiveDelay::AsyncAdaptiveDelay(unsigned long minInterval,
+                                       unsigned long maxInterval,
+                                       unsigned long threshold)
+    : AsyncDelay(maxInterval), threshold(threshold) {
+    this->setRange(minInterval, maxInterval);
+}
+
+/**
+ * @brief Clamps a new interval into the range and applies it with the
+ * retime mode, so the progress toward the next deadline is not lost.
+ *
+ * @param[in] interval The new interval in milliseconds.
+ * @param[in] now The current time in milliseconds.
+ */
+void AsyncAdaptiveDelay::retime(unsigned long interval, unsigned long now) {
+    if (interval < this->minInterval) {
+        interval = this->minInterval;
+    } else if (interval > this->maxInterval) {
+        interval = this->maxInterval;
+    }
+
+    if (interval != this->interval) {
+        this->setInterval(interval, this->retimeMode, now);
+    }
+}
+
+/**
+ * @brief Sets the interval range.
+ *
+ * Both limits are clamped to [1, AsyncDelay::MAX_INTERVAL]; if they are
+ * swapped, they are exchanged. The current interval is clamped into the new
+ * range.
+ *
+ * @param[in] minInterval The shortest interval in milliseconds.
+ * @param[in] maxInterval The longest interval in milliseconds.
+ */
+void AsyncAdaptiveDelay::setRange(unsigned long minInterval,
+                                  unsigned long maxInterval) {
+    if (minInterval > maxInterval) {
+        unsigned long swap = minInterval;
+        minInterval = maxInterval;
+        maxInterval = swap;
+    }
+
+    this->minInterval = minInterval == 0 ? 1 : minInterval;
+    this->maxInterval =
+        maxInterval > MAX_INTERVAL ? MAX_INTERVAL : maxInterval;
+    if (this->maxInterval < this->minInterval) {
+        this->maxInterval = this->minInterval;
+    }
+
+    this->retime(this->interval, AsyncClock::read());
+}
+
+/**
+ * @brief Gets the shortest interval.
+ *
+ * @return The shortest interval in milliseconds.
+ */
+unsigned long AsyncAdaptiveDelay::getMinInterval() {
+    return this->minInterval;
+}
+
+/**
+ * @brief Gets the longest interval.
+ *
+ * @return The longest interval in milliseconds.
+ */
+unsigned long AsyncAdaptiveDelay::getMaxInterval() {
+    return this->maxInterval;
+}
+
+/**
+ * @brief Sets the activity at which the interval is shortened.
+ *
+ * @param[in] threshold The activity threshold.
+ */
+void AsyncAdaptiveDelay::setThreshold(unsigned long threshold) {
+    this->threshold = threshold;
+}
+
+/**
+ * @brief Gets the activity threshold.
+ *
+ * @return The activity threshold.
+ */
+unsigned long AsyncAdaptiveDelay::getThreshold() {
+    return this->threshold;
+}
+
+/**
+ * @brief Sets how adapt() treats the running period.
+ *
+ * @param[in] mode The retime mode.
+ */
+void AsyncAdaptiveDelay::setRetimeMode(RetimeMode mode) {
+    this->retimeMode = mode;
+}
+
+/**
+ * @brief Adapts the interval to the activity of the last sample.
+ *
+ * @param[in] activity The activity metric, in the unit of the threshold.
+ *
+ * @return The new interval in milliseconds.
+ */
+unsigned long AsyncAdaptiveDelay::adapt(unsigned long activity) {
+    return this->adapt(activity, AsyncClock::read());
+}
+
+/**
+ * @brief Adapts the interval to the activity of the last sample at the given
+ * time.
+ *
+ * Activity at or above the threshold halves the interval; lower activity
+ * lengthens it by one eighth (at least 1 ms). The running period is
+ * treated as selected by setRetimeMode().
+ *
+ * @param[in] activity The activity metric, in the unit of the threshold.
+ * @param[in] now The current time in milliseconds.
+ *
+ * @return The new interval in milliseconds.
+ */
+unsigned long AsyncAdaptiveDelay::adapt(unsigned long activity,
+                                        unsigned long now) {
+    if (activity >= this->threshold) {
+        this->retime(this->interval / 2, now);
+    } else {
+        unsigned long step = this->interval >> DECAY_SHIFT;
+        this->retime(this->interval + (step == 0 ? 1 : step), now);
+    }
+
+    return this->interval;
+}
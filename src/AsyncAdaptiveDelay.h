@@ -0,0 +1,138 @@
+/**
+ * @file AsyncAdaptiveDelay.h
+ *
+ * @brief Provides a delay whose interval follows the activity of a signal.
+ *
+ * @author boolscope
+ */
+#ifndef _ASYNC_ADAPTIVE_DELAY_H
+#define _ASYNC_ADAPTIVE_DELAY_H
+
+#include "AsyncDelay.h"
+
+/**
+ * @class AsyncAdaptiveDelay
+ * @brief A periodic timer that samples fast while a signal changes and slow
+ * while it is quiet.
+ *
+ * After every sample the application reports an activity metric (e.g. the
+ * absolute change since the previous sample) to adapt(). An activity at or
+ * above the threshold halves the interval, down to the minimum; a quieter
+ * sample lengthens it by one eighth, up to the maximum. The fast attack
+ * catches the start of an event within a few samples, the slow decay avoids
+ * oscillating when the activity hovers around the threshold.
+ *
+ * Retiming keeps the phase: by default (RETIME_KEEP_ELAPSED) the timestamp
+ * of the current period is not reset, so the next deadline is the start of
+ * the period plus the new interval. A shortened interval that has already
+ * elapsed makes the timer ready on the next check. setRetimeMode() selects
+ * another AsyncDelay::RetimeMode.
+ *
+ * @code
+ * AsyncAdaptiveDelay sampler(50, 5000, 4);
+ * int last = 0;
+ *
+ * void loop() {
+ *   if (sampler.isReady()) {
+ *     int value = analogRead(A0);
+ *     sampler.adapt(abs(value - last));
+ *     last = value;
+ *   }
+ * }
+ * @endcode
+ */
+class AsyncAdaptiveDelay : public AsyncDelay {
+private:
+    /** @brief The shortest interval in milliseconds. */
+    unsigned long minInterval;
+
+    /** @brief The longest interval in milliseconds. */
+    unsigned long maxInterval;
+
+    /** @brief The activity at which the interval is shortened. */
+    unsigned long threshold;
+
+    /** @brief How adapt() treats the running period. */
+    RetimeMode retimeMode = RETIME_KEEP_ELAPSED;
+
+    /** @brief Clamps and applies a new interval with the retime mode. */
+    void retime(unsigned long interval, unsigned long now);
+
+public:
+    // A quiet sample lengthens the interval by interval >> DECAY_SHIFT.
+    static const unsigned char DECAY_SHIFT = 3;
+
+    /** @brief Constructs a new AsyncAdaptiveDelay object.
+     *
+     * The timer starts with the longest interval.
+     *
+     * @param[in] minInterval The shortest interval in milliseconds.
+     * @param[in] maxInterval The longest interval in milliseconds.
+     * @param[in] threshold The activity at which the interval is shortened.
+     */
+    AsyncAdaptiveDelay(unsigned long minInterval, unsigned long maxInterval,
+                       unsigned long threshold);
+
+    /** @brief Sets the interval range and clamps the current interval.
+     *
+     * @param[in] minInterval The shortest interval in milliseconds.
+     * @param[in] maxInterval The longest interval in milliseconds.
+     *
+     * @return void
+     */
+    void setRange(unsigned long minInterval, unsigned long maxInterval);
+
+    /** @brief Gets the shortest interval.
+     *
+     * @return The shortest interval in milliseconds.
+     */
+    unsigned long getMinInterval();
+
+    /** @brief Gets the longest interval.
+     *
+     * @return The longest interval in milliseconds.
+     */
+    unsigned long getMaxInterval();
+
+    /** @brief Sets the activity at which the interval is shortened.
+     *
+     * @param[in] threshold The activity threshold.
+     *
+     * @return void
+     */
+    void setThreshold(unsigned long threshold);
+
+    /** @brief Gets the activity threshold.
+     *
+     * @return The activity threshold.
+     */
+    unsigned long getThreshold();
+
+    /** @brief Sets how adapt() treats the running period.
+     *
+     * @param[in] mode The retime mode. Defaults to RETIME_KEEP_ELAPSED.
+     *
+     * @return void
+     */
+    void setRetimeMode(RetimeMode mode);
+
+    /** @brief Adapts the interval to the activity of the last sample.
+     *
+     * @param[in] activity The activity metric, in the unit of the threshold.
+     *
+     * @return The new interval in milliseconds.
+     */
+    unsigned long adapt(unsigned long activity);
+
+    /** @brief Adapts the interval to the activity of the last sample at the
+     * given time.
+     *
+     * @param[in] activity The activity metric, in the unit of the threshold.
+     * @param[in] now The current time in milliseconds.
+     *
+     * @return The new interval in milliseconds.
+     */
+    unsigned long adapt(unsigned long activity, unsigned long now);
+};
+
+#endif  // _ASYNC_ADAPTIVE_DELAY_H
@@ -0,0 +1,239 @@
+/**
+ * @file AsyncBatcher.h
+ *
+ * @brief Provides a double-buffered batcher that flushes when a buffer is
+ * full or a maximum latency has passed.
+ *
+ * @author boolscope
+ */
+#ifndef _ASYNC_BATCHER_H
+#define _ASYNC_BATCHER_H
+
+#include <Arduino.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "AsyncClock.h"
+#include "AsyncDelay.h"
+
+/**
+ * @class AsyncBatcher
+ * @brief Accumulates records into fixed buffers and hands whole batches to a
+ * flush function.
+ *
+ * A batch is flushed when its buffer is full or when the oldest record in it
+ * has waited `maxLatency` milliseconds, whichever comes first. The latency is
+ * measured by an AsyncDelay that starts with the first record of a batch.
+ *
+ * The flush function receives a pointer into the buffer and the number of
+ * records, so nothing is copied. There are two buffers: while one is being
+ * flushed, records are accumulated in the other. A flush function that
+ * finishes synchronously returns true. One that only starts a transfer (DMA,
+ * a radio driver) returns false; the buffer then stays in flight and must be
+ * handed back with release() when the transfer is done. Until then a full
+ * second buffer cannot be flushed, and add() fails instead of overwriting
+ * records.
+ *
+ * @code
+ * bool send(const Reading *records, size_t count) {
+ *   return radio.send(records, count * sizeof(Reading));
+ * }
+ *
+ * AsyncBatcher<Reading, 16> batch(send, 1000);
+ *
+ * void loop() {
+ *   if (sampleDelay.isReady()) {
+ *     batch.add(readSensor());
+ *   }
+ *   batch.poll();
+ * }
+ * @endcode
+ *
+ * @tparam T The record type.
+ * @tparam Capacity The number of records per batch.
+ */
+template <typename T, size_t Capacity>
+class AsyncBatcher {
+public:
+    /** @brief Flushes a batch.
+     *
+     * Returns true when the records have been consumed, or false when the
+     * buffer is still in use and will be handed back with release().
+     */
+    typedef bool (*FlushFunction)(const T *records, size_t count);
+
+private:
+    /** @brief The two record buffers. */
+    T buffers[2][Capacity];
+
+    /** @brief The number of records in the buffer being filled. */
+    size_t count = 0;
+
+    /** @brief The index of the buffer being filled. */
+    uint8_t active = 0;
+
+    /** @brief Set while the other buffer is owned by the flush function. */
+    bool inFlight = false;
+
+    /** @brief Measures the age of the oldest record of the batch. */
+    AsyncDelay latency;
+
+    /** @brief The flush function. */
+    FlushFunction flushFunction;
+
+public:
+    // The number of records per batch.
+    static const size_t CAPACITY = Capacity;
+
+    /** @brief Constructs a new AsyncBatcher object.
+     *
+     * @param[in] fn The flush function.
+     * @param[in] maxLatency The maximum time a record waits in a batch, in
+     * milliseconds. 0 flushes only full batches.
+     */
+    AsyncBatcher(FlushFunction fn, unsigned long maxLatency)
+        : latency(maxLatency), flushFunction(fn) {
+    }
+
+    /** @brief Returns the number of records in the current batch.
+     *
+     * @return The number of records.
+     */
+    size_t size() {
+        return this->count;
+    }
+
+    /** @brief Checks if a flushed buffer has not been released yet.
+     *
+     * @return True while a buffer is in flight.
+     */
+    bool isInFlight() {
+        return this->inFlight;
+    }
+
+    /** @brief Reserves the next record in the current batch.
+     *
+     * The record is written in place by the caller and counts as added. If
+     * it fills the batch, the batch is flushed by the next poll() or add().
+     *
+     * @param[in] now The current time in milliseconds.
+     *
+     * @return The record to fill, or nullptr if both buffers are full.
+     */
+    T *reserve(unsigned long now) {
+        if (this->count == Capacity && !this->flush()) {
+            return nullptr;
+        }
+
+        if (this->count == 0) {
+            this->latency.resetTime(now);
+        }
+
+        return &this->buffers[this->active][this->count++];
+    }
+
+    /** @brief Reserves the next record in the current batch.
+     *
+     * @return The record to fill, or nullptr if both buffers are full.
+     */
+    T *reserve() {
+        return this->reserve(AsyncClock::read());
+    }
+
+    /** @brief Copies a record into the current batch and flushes the batch
+     * if it is full.
+     *
+     * @param[in] record The record.
+     * @param[in] now The current time in milliseconds.
+     *
+     * @retval true if the record was added.
+     * @retval false if both buffers are full.
+     */
+    bool add(const T &record, unsigned long now) {
+        T *slot = this->reserve(now);
+        if (slot == nullptr) {
+            return false;
+        }
+
+        *slot = record;
+        if (this->count == Capacity) {
+            this->flush();
+        }
+
+        return true;
+    }
+
+    /** @brief Copies a record into the current batch and flushes the batch
+     * if it is full.
+     *
+     * @param[in] record The record.
+     *
+     * @retval true if the record was added.
+     * @retval false if both buffers are full.
+     */
+    bool add(const T &record) {
+        return this->add(record, AsyncClock::read());
+    }
+
+    /** @brief Flushes the current batch if it is full or too old.
+     *
+     * @param[in] now The current time in milliseconds.
+     *
+     * @retval true if a batch was flushed.
+     * @retval false otherwise.
+     */
+    bool poll(unsigned long now) {
+        if (this->count == 0) {
+            return false;
+        }
+
+        if (this->count < Capacity && !this->latency.isDone(now)) {
+            return false;
+        }
+
+        return this->flush();
+    }
+
+    /** @brief Flushes the current batch if it is full or too old.
+     *
+     * @retval true if a batch was flushed.
+     * @retval false otherwise.
+     */
+    bool poll() {
+        return this->poll(AsyncClock::read());
+    }
+
+    /** @brief Flushes the current batch now.
+     *
+     * Swaps the buffers and passes the filled one to the flush function.
+     *
+     * @retval true if a batch was flushed.
+     * @retval false if the batch is empty or the other buffer is in flight.
+     */
+    bool flush() {
+        if (this->count == 0 || this->inFlight) {
+            return false;
+        }
+
+        const T *records = this->buffers[this->active];
+        size_t n = this->count;
+
+        // Swap first, so the flush function may already add records.
+        this->active ^= 1;
+        this->count = 0;
+        this->inFlight = true;
+
+        if (this->flushFunction(records, n)) {
+            this->inFlight = false;
+        }
+
+        return true;
+    }
+
+    /** @brief Hands a buffer back after an asynchronous flush. */
+    void release() {
+        this->inFlight = false;
+    }
+};
+
+#endif  // _ASYNC_BATCHER_H
@@ -0,0 +1,192 @@
+#include "AsyncChunkJob.h"
+
+#include <Arduino.h>
+
+#include "AsyncClock.h"
+
+/**
+ * @brief Constructs a new AsyncChunkJob object and starts it.
+ *
+ * The first chunk is a single unit; the size grows from there.
+ *
+ * @param[in] step The step function.
+ * @param[in] context The context pointer passed to the step function.
+ * @param[in] total The total number of units.
+ * @param[in] budget The time budget of one chunk in microseconds.
+ * @param[in] maxChunk The largest chunk in units.
+ */
+AsyncChunkJob::AsyncChunkJob(AsyncChunkStep step, void *context,
+                             unsigned long total, unsigned long budget,
+                             unsigned int maxChunk)
+    : step(step),
+      context(context),
+      total(total),
+      budget(budget == 0 ? 1 : budget),
+      maxChunk(maxChunk == 0 ? 1 : maxChunk) {
+    this->start();
+}
+
+/**
+ * @brief Restarts the job from the first unit.
+ */
+void AsyncChunkJob::start() {
+    this->done = 0;
+    this->failed = false;
+    this->running = this->total != 0;
+    this->startTime = AsyncClock::read();
+}
+
+/**
+ * @brief Restarts the job with a new amount of work.
+ *
+ * @param[in] total The total number of units.
+ */
+void AsyncChunkJob::start(unsigned long total) {
+    this->total = total;
+    this->start();
+}
+
+/**
+ * @brief Sets the time budget of one chunk.
+ *
+ * @param[in] budget The budget in microseconds.
+ */
+void AsyncChunkJob::setBudget(unsigned long budget) {
+    this->budget = budget == 0 ? 1 : budget;
+}
+
+/**
+ * @brief Processes one chunk and adapts the size of the next one.
+ *
+ * The next chunk is scaled by budget / duration of this one, limited to
+ * doubling, so the size converges within a few chunks and follows changes
+ * of the cost per unit.
+ *
+ * @return `true` if a chunk was processed, `false` if the job is not
+ * running.
+ */
+bool AsyncChunkJob::run() {
+    if (!this->running) {
+        return false;
+    }
+
+    unsigned int count = this->chunk;
+    if (count > this->total - this->done) {
+        count = this->total - this->done;
+    }
+
+    unsigned long start = micros();
+    unsigned int processed = this->step(this->context, this->done, count);
+    unsigned long elapsed = micros() - start;
+
+    if (processed == 0) {
+        this->running = false;
+        this->failed = true;
+        return true;
+    }
+
+    if (processed > count) {
+        processed = count;
+    }
+
+    this->done += processed;
+    if (this->done == this->total) {
+        this->running = false;
+    }
+
+    // Only full chunks say something about the right size.
+    if (processed == this->chunk) {
+        unsigned long long target =
+            elapsed == 0 ? (unsigned long long)processed * 2
+                         : (unsigned long long)processed * this->budget /
+                               elapsed;
+        if (target > (unsigned long long)processed * 2) {
+            target = (unsigned long long)processed * 2;
+        }
+
+        if (target > this->maxChunk) {
+            target = this->maxChunk;
+        }
+
+        this->chunk = target == 0 ? 1 : (unsigned int)target;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Checks if the job still has work to do.
+ *
+ * @return `true` between start() and the completion or abort of the job.
+ */
+bool AsyncChunkJob::isRunning() {
+    return this->running;
+}
+
+/**
+ * @brief Checks if all units have been processed.
+ *
+ * @return `true` if the job is complete.
+ */
+bool AsyncChunkJob::isDone() {
+    return !this->failed && this->done == this->total;
+}
+
+/**
+ * @brief Checks if the step function aborted the job.
+ *
+ * @return `true` if the job was aborted.
+ */
+bool AsyncChunkJob::isFailed() {
+    return this->failed;
+}
+
+/**
+ * @brief Retrieves the number of units processed.
+ *
+ * @return The number of units.
+ */
+unsigned long AsyncChunkJob::getProgress() {
+    return this->done;
+}
+
+/**
+ * @brief Retrieves the progress in percent.
+ *
+ * @return The progress from 0 to 100.
+ */
+uint8_t AsyncChunkJob::getPercent() {
+    if (this->total == 0) {
+        return 100;
+    }
+
+    return (uint8_t)((unsigned long long)this->done * 100 / this->total);
+}
+
+/**
+ * @brief Retrieves the current chunk size.
+ *
+ * @return The number of units of the next chunk.
+ */
+unsigned int AsyncChunkJob::getChunk() {
+    return this->chunk;
+}
+
+/**
+ * @brief Estimates the time until the job is complete.
+ *
+ * Extrapolates the wall-clock throughput since start() to the remaining
+ * units.
+ *
+ * @return The time in milliseconds, 0 if the job is not running or no
+ * estimate is possible yet.
+ */
+unsigned long AsyncChunkJob::getEta() {
+    if (!this->running || this->done == 0) {
+        return 0;
+    }
+
+    unsigned long wall = AsyncClock::read() - this->startTime;
+    return (unsigned long)((unsigned long long)wall *
+                           (this->total - this->done) / this->done);
+}
@@ -0,0 +1,180 @@
+/**
+ * @file AsyncChunkJob.h
+ *
+ * @brief Provides resumable jobs that process their work in time-budgeted
+ * chunks.
+ *
+ * @author boolscope
+ */
+#ifndef _ASYNC_CHUNK_JOB_H
+#define _ASYNC_CHUNK_JOB_H
+
+#include <stdint.h>
+
+/**
+ * @brief Processes one chunk of a job.
+ *
+ * @param[in] context The context pointer given to the job.
+ * @param[in] offset The index of the first unit to process.
+ * @param[in] count The number of units to process.
+ *
+ * @return The number of units processed, at most `count`. Returning 0
+ * aborts the job.
+ */
+typedef unsigned int (*AsyncChunkStep)(void *context, unsigned long offset,
+                                       unsigned int count);
+
+/**
+ * @class AsyncChunkJob
+ * @brief Splits a long operation (a CRC over flash, bulk EEPROM writes, ...)
+ * into chunks that fit into a time budget per loop iteration.
+ *
+ * The work is measured in units (bytes, pages, records) from 0 to `total`.
+ * Every call to run() processes one chunk and returns, so loop() and the
+ * timers keep running between chunks. After each chunk the chunk size is
+ * adapted to the measured duration so that a chunk takes about `budget`
+ * microseconds: a chunk that took too long shrinks the next one at once,
+ * a fast one at most doubles it.
+ *
+ * Progress and the estimated time to completion are derived from the
+ * wall-clock time since start(), so they include the time spent between
+ * chunks.
+ *
+ * @code
+ * uint32_t crc;
+ *
+ * unsigned int crcStep(void *, unsigned long offset, unsigned int count) {
+ *   crc = crc32Update(crc, (const uint8_t *)FLASH_BASE + offset, count);
+ *   return count;
+ * }
+ *
+ * AsyncChunkJob check(crcStep, nullptr, 262144, 500);
+ *
+ * void loop() {
+ *   scheduler.poll();
+ *   if (check.run() && check.isDone()) {
+ *     report(crc);
+ *   }
+ * }
+ * @endcode
+ */
+class AsyncChunkJob {
+private:
+    /** @brief The step function. */
+    AsyncChunkStep step;
+
+    /** @brief The context pointer passed to the step function. */
+    void *context;
+
+    /** @brief The total number of units. */
+    unsigned long total;
+
+    /** @brief The number of units processed. */
+    unsigned long done = 0;
+
+    /** @brief The time budget of one chunk in microseconds. */
+    unsigned long budget;
+
+    /** @brief The number of units of the next chunk. */
+    unsigned int chunk = 1;
+
+    /** @brief The upper bound of the chunk size. */
+    unsigned int maxChunk;
+
+    /** @brief The time start() was called, in milliseconds. */
+    unsigned long startTime = 0;
+
+    /** @brief Set between start() and the end of the job. */
+    bool running = false;
+
+    /** @brief Set when the step function aborted the job. */
+    bool failed = false;
+
+public:
+    /** @brief Constructs a new AsyncChunkJob object and starts it.
+     *
+     * @param[in] step The step function.
+     * @param[in] context The context pointer passed to the step function.
+     * @param[in] total The total number of units.
+     * @param[in] budget The time budget of one chunk in microseconds.
+     * @param[in] maxChunk The largest chunk in units. Defaults to 4096.
+     */
+    AsyncChunkJob(AsyncChunkStep step, void *context, unsigned long total,
+                  unsigned long budget, unsigned int maxChunk = 4096);
+
+    /** @brief Restarts the job from the first unit.
+     *
+     * The learned chunk size is kept.
+     *
+     * @return void
+     */
+    void start();
+
+    /** @brief Restarts the job with a new amount of work.
+     *
+     * @param[in] total The total number of units.
+     *
+     * @return void
+     */
+    void start(unsigned long total);
+
+    /** @brief Sets the time budget of one chunk.
+     *
+     * @param[in] budget The budget in microseconds.
+     *
+     * @return void
+     */
+    void setBudget(unsigned long budget);
+
+    /** @brief Processes one chunk.
+     *
+     * @retval true if a chunk was processed.
+     * @retval false if the job is not running.
+     */
+    bool run();
+
+    /** @brief Checks if the job still has work to do.
+     *
+     * @return True between start() and the completion or abort of the job.
+     */
+    bool isRunning();
+
+    /** @brief Checks if all units have been processed.
+     *
+     * @return True if the job is complete.
+     */
+    bool isDone();
+
+    /** @brief Checks if the step function aborted the job.
+     *
+     * @return True if the job was aborted.
+     */
+    bool isFailed();
+
+    /** @brief Retrieves the number of units processed.
+     *
+     * @return The number of units.
+     */
+    unsigned long getProgress();
+
+    /** @brief Retrieves the progress in percent.
+     *
+     * @return The progress from 0 to 100.
+     */
+    uint8_t getPercent();
+
+    /** @brief Retrieves the current chunk size.
+     *
+     * @return The number of units of the next chunk.
+     */
+    unsigned int getChunk();
+
+    /** @brief Estimates the time until the job is complete.
+     *
+     * @return The time in milliseconds, 0 if the job is not running or no
+     * estimate is possible yet.
+     */
+    unsigned long getEta();
+};
+
+#endif  // _ASYNC_CHUNK_JOB_H
@@ -0,0 +1,34 @@
+#include "AsyncClock.h"
+
+#include <Arduino.h>
+
+unsigned long AsyncClock::cached = 0;
+AsyncTimeSource AsyncClock::source = nullptr;
+
+/**
+ * @brief Sets the clock.
+ *
+ * @param[in] fn The clock, or nullptr to use millis().
+ */
+void AsyncClock::setSource(AsyncTimeSource fn) {
+    source = fn;
+}
+
+/**
+ * @brief Reads the clock without caching the value.
+ *
+ * @return The current time in milliseconds, as returned by the source.
+ */
+unsigned long AsyncClock::read() {
+    return source == nullptr ? millis() : source();
+}
+
+/**
+ * @brief Reads the clock and caches the value.
+ *
+ * @return The current time in milliseconds, as returned by read().
+ */
+unsigned long AsyncClock::tick() {
+    cached = read();
+    return cached;
+}
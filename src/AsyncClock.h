@@ -0,0 +1,80 @@
+/**
+ * @file AsyncClock.h
+ *
+ * @brief Provides a per-loop cached millisecond timestamp.
+ *
+ * @author boolscope
+ */
+#ifndef _ASYNC_CLOCK_H
+#define _ASYNC_CLOCK_H
+
+/**
+ * @brief Returns the current time in milliseconds, like millis().
+ */
+typedef unsigned long (*AsyncTimeSource)();
+
+/**
+ * @class AsyncClock
+ * @brief Caches one millis() reading so hot paths do not read the clock.
+ *
+ * tick() reads the clock and stores the value; now() returns the stored
+ * value and costs a plain memory load. AsyncScheduler::poll() calls tick(),
+ * so code running in the same loop iteration can use now(). The cached value
+ * is at most one loop iteration old.
+ *
+ * The clock is millis() unless another source is set with setSource(), e.g.
+ * a disciplined clock (see AsyncClockDiscipline). AsyncDelay and every
+ * method of the library that defaults its millisecond `now` read the clock
+ * through read(), so all timers and queues follow the same source.
+ *
+ * @code
+ * void loop() {
+ *   AsyncClock::tick();     // or scheduler.poll()
+ *   if (packetReceived()) {
+ *     linkWatchdog.kick();  // uses AsyncClock::now()
+ *   }
+ * }
+ * @endcode
+ */
+class AsyncClock {
+private:
+    /** @brief The time of the last tick() in milliseconds. */
+    static unsigned long cached;
+
+    /** @brief The clock, nullptr for millis(). */
+    static AsyncTimeSource source;
+
+public:
+    /** @brief Sets the clock.
+     *
+     * The source must not jump, or timers jump with it. Set it before the
+     * timers are started.
+     *
+     * @param[in] fn The clock, or nullptr to use millis().
+     *
+     * @return void
+     */
+    static void setSource(AsyncTimeSource fn);
+
+    /** @brief Reads the clock without caching the value.
+     *
+     * @return The current time in milliseconds.
+     */
+    static unsigned long read();
+
+    /** @brief Reads the clock and caches the value.
+     *
+     * @return The current time in milliseconds.
+     */
+    static unsigned long tick();
+
+    /** @brief Returns the time cached by the last tick().
+     *
+     * @return The cached time in milliseconds.
+     */
+    static unsigned long now() {
+        return cached;
+    }
+};
+
+#endif  // _ASYNC_CLOCK_H
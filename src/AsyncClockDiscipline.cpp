@@ -0,0 +1,224 @@
+#include "AsyncClockDiscipline.h"
+
+// One microsecond in the Q32 fixed-point format.
+static const long long ONE = 4294967296LL;
+
+/**
+ * @brief Constructs a new AsyncClockDiscipline object.
+ *
+ * @param[in] pulsePeriod The period of the reference pulse in microseconds.
+ */
+AsyncClockDiscipline::AsyncClockDiscipline(unsigned long pulsePeriod)
+    : pulsePeriod(pulsePeriod == 0 ? 1 : pulsePeriod) {}
+
+/**
+ * @brief Captures a reference pulse at the current time.
+ */
+void AsyncClockDiscipline::onPulse() {
+    this->onPulse(micros());
+}
+
+/**
+ * @brief Captures a reference pulse.
+ *
+ * Producer side of the ring. If the ring is full, the pulse is dropped.
+ *
+ * @param[in] local The micros() value of the pulse.
+ */
+void AsyncClockDiscipline::onPulse(unsigned long local) {
+    this->pulses.push(local);
+}
+
+/**
+ * @brief Advances the corrected clock to a micros() value.
+ *
+ * The elapsed raw time is scaled by the rate correction, and up to
+ * 1/2^SLEW_SHIFT of it is added or taken away for the pending slew. The
+ * result is never negative, so the clock is monotonic. Fractions of a
+ * microsecond are carried over.
+ *
+ * @param[in] raw The micros() value.
+ */
+void AsyncClockDiscipline::advance(unsigned long raw) {
+    if (!this->started) {
+        this->lastRaw = raw;
+        this->started = true;
+        return;
+    }
+
+    unsigned long delta = raw - this->lastRaw;
+    this->lastRaw = raw;
+
+    long long step = (long long)delta * this->correction + this->fraction;
+
+    long long limit = (long long)delta * (ONE >> SLEW_SHIFT);
+    long long s = this->slew;
+    if (s > limit) {
+        s = limit;
+    } else if (s < -limit) {
+        s = -limit;
+    }
+
+    this->slew -= s;
+    step += s;
+
+    long long whole = step >= 0 ? step / ONE : -((-step + ONE - 1) / ONE);
+    this->fraction = (uint32_t)(step - whole * ONE);
+
+    unsigned long long total = this->us + (unsigned long long)delta + whole;
+    this->ms += (unsigned long)(total / 1000);
+    this->us = (unsigned long)(total % 1000);
+}
+
+/**
+ * @brief Processes a reference sample.
+ *
+ * The first sample defines the mapping between the corrected clock and the
+ * reference. Later samples measure the rate once MIN_SPAN has passed since
+ * the last measurement, and replace the pending slew with the current
+ * offset. A measurement that deviates from the correction by more than the
+ * tolerance is a step of the reference: it is slewed like any offset, and
+ * the rate measurement restarts at this sample.
+ *
+ * @param[in] reference The reference time in microseconds, modulo 2^32.
+ * @param[in] local The micros() value of the sample.
+ */
+void AsyncClockDiscipline::sample(unsigned long reference,
+                                  unsigned long local) {
+    unsigned long corrected = this->ms * 1000 + this->us -
+                              (this->lastRaw - local);
+
+    if (!this->referenced) {
+        this->referenceOffset = reference - corrected;
+        this->lastReference = reference;
+        this->lastLocal = local;
+        this->referenced = true;
+        return;
+    }
+
+    unsigned long span = local - this->lastLocal;
+    if (span >= MIN_SPAN) {
+        long error = (long)((reference - this->lastReference) - span);
+        long long measured = (long long)error * ONE / (long long)span;
+        long long deviation = measured - (this->locked ? this->correction
+                                                       : 0);
+        long long tolerance = ONE >> TOLERANCE_SHIFT;
+        if (deviation > tolerance || -deviation > tolerance) {
+            // A step, not a rate: keep the correction.
+        } else if (!this->locked) {
+            this->correction = (long)measured;
+            this->locked = true;
+        } else {
+            this->correction += (long)(deviation / (1 << GAIN_SHIFT));
+        }
+
+        this->lastReference = reference;
+        this->lastLocal = local;
+    }
+
+    long offset = (long)(reference - this->referenceOffset - corrected);
+    this->slew = (long long)offset * ONE;
+}
+
+/**
+ * @brief Supplies the reference time.
+ *
+ * @param[in] reference The reference time in milliseconds.
+ */
+void AsyncClockDiscipline::addReference(unsigned long reference) {
+    this->addReference(reference, micros());
+}
+
+/**
+ * @brief Supplies the reference time at a given local time.
+ *
+ * @param[in] reference The reference time in milliseconds.
+ * @param[in] local The micros() value the reference time belongs to.
+ */
+void AsyncClockDiscipline::addReference(unsigned long reference,
+                                        unsigned long local) {
+    this->advance(micros());
+    this->sample(reference * 1000, local);
+}
+
+/**
+ * @brief Processes the captured pulses.
+ *
+ * The reference time of a pulse advances by the pulse period times the
+ * number of periods since the last pulse, rounded, so missed pulses are
+ * bridged. A pulse less than half a period after the last one is ignored.
+ *
+ * @return `true` if a pulse was accepted.
+ */
+bool AsyncClockDiscipline::update() {
+    this->advance(micros());
+
+    bool accepted = false;
+    unsigned long local;
+    while (this->pulses.pop(local)) {
+        if (this->pulsed) {
+            unsigned long periods = (local - this->lastPulse +
+                                     this->pulsePeriod / 2) /
+                                    this->pulsePeriod;
+            if (periods == 0) {
+                continue;
+            }
+
+            this->pulseReference += periods * this->pulsePeriod;
+        }
+
+        this->pulsed = true;
+        this->lastPulse = local;
+        this->sample(this->pulseReference, local);
+        accepted = true;
+    }
+
+    return accepted;
+}
+
+/**
+ * @brief Reads the corrected clock.
+ *
+ * @return The corrected time in milliseconds.
+ */
+unsigned long AsyncClockDiscipline::getMillis() {
+    this->advance(micros());
+    return this->ms;
+}
+
+/**
+ * @brief Reads the corrected clock.
+ *
+ * @return The corrected time in microseconds, modulo 2^32.
+ */
+unsigned long AsyncClockDiscipline::getMicros() {
+    this->advance(micros());
+    return this->ms * 1000 + this->us;
+}
+
+/**
+ * @brief Checks if the rate has been measured.
+ *
+ * @return `true` once a rate correction is applied.
+ */
+bool AsyncClockDiscipline::isLocked() {
+    return this->locked;
+}
+
+/**
+ * @brief Retrieves the rate correction.
+ *
+ * @return The correction in parts per million.
+ */
+long AsyncClockDiscipline::getCorrection() {
+    return (long)((long long)this->correction * 1000000 / ONE);
+}
+
+/**
+ * @brief Retrieves the offset that is still being slewed.
+ *
+ * @return The offset in microseconds.
+ */
+long AsyncClockDiscipline::getOffset() {
+    return (long)(this->slew / ONE);
+}
@@ -0,0 +1,220 @@
+/**
+ * @file AsyncClockDiscipline.h
+ *
+ * @brief Provides a clock that is disciplined against a reference: its rate
+ * is corrected for the measured drift and its offset is slewed.
+ *
+ * @author boolscope
+ */
+#ifndef _ASYNC_CLOCK_DISCIPLINE_H
+#define _ASYNC_CLOCK_DISCIPLINE_H
+
+#include <Arduino.h>
+#include <stdint.h>
+
+#include "AsyncSpscRing.h"
+
+/**
+ * @class AsyncClockDiscipline
+ * @brief Derives a corrected millisecond clock from micros() and a
+ * reference.
+ *
+ * The reference is either a pulse with a known period (GPS PPS, an RTC
+ * square wave), captured in its interrupt handler with onPulse(), or
+ * timestamps supplied by a host with addReference(). Use one kind only.
+ *
+ * Every reference sample at least MIN_SPAN after the previous measurement
+ * yields the rate error of micros(). The correction is kept as a signed
+ * fraction in 1/2^32 (Q32) and follows the measurements with an exponential
+ * moving average (GAIN_SHIFT); the first measurement is taken as is. A
+ * measurement more than 1/2^TOLERANCE_SHIFT away from the correction is a
+ * step of the reference, not a rate: it only adds to the offset.
+ *
+ * The offset between the corrected clock and the reference is never
+ * stepped. It is slewed: the clock runs up to 1/2^SLEW_SHIFT faster or
+ * slower until the offset is gone, so the time stays monotonic and timers
+ * neither jump nor fire twice. The first reference sample only defines
+ * the mapping to the reference, so the clock does not follow the absolute
+ * time of a host, only its rate.
+ *
+ * getMillis() has to be called at least once per 71 minutes, which
+ * AsyncScheduler::poll() does when the clock is set as the AsyncClock
+ * source.
+ *
+ * @code
+ * AsyncClockDiscipline discipline;  // 1 s pulses
+ *
+ * unsigned long disciplinedMillis() {
+ *   return discipline.getMillis();
+ * }
+ *
+ * void onPps() {  // interrupt handler
+ *   discipline.onPulse();
+ * }
+ *
+ * void setup() {
+ *   AsyncClock::setSource(disciplinedMillis);
+ *   attachInterrupt(digitalPinToInterrupt(PPS_PIN), onPps, RISING);
+ *   hourly.resetTime();
+ * }
+ *
+ * void loop() {
+ *   discipline.update();
+ *   scheduler.poll();
+ * }
+ * @endcode
+ */
+class AsyncClockDiscipline {
+public:
+    // The weight of a new rate measurement, 1/2^GAIN_SHIFT.
+    static const uint8_t GAIN_SHIFT = 2;
+
+    // Rate changes above 1/2^TOLERANCE_SHIFT (1.6%) are taken as steps.
+    static const uint8_t TOLERANCE_SHIFT = 6;
+
+    // The offset is slewed at 1/2^SLEW_SHIFT (488 ppm).
+    static const uint8_t SLEW_SHIFT = 11;
+
+    // The minimum time between two rate measurements in microseconds.
+    static const unsigned long MIN_SPAN = 1000000;
+
+private:
+    /** @brief Pulse timestamps on their way from the ISR to update(). */
+    AsyncSpscRing<unsigned long, 4> pulses;
+
+    /** @brief The pulse period in reference microseconds. */
+    unsigned long pulsePeriod;
+
+    /** @brief The rate correction in 1/2^32. */
+    long correction = 0;
+
+    /** @brief The offset still to be slewed in 1/2^32 µs. */
+    long long slew = 0;
+
+    /** @brief The micros() value of the last advance. */
+    unsigned long lastRaw = 0;
+
+    /** @brief The corrected time in milliseconds. */
+    unsigned long ms = 0;
+
+    /** @brief The corrected microseconds beyond `ms`, below 1000. */
+    unsigned long us = 0;
+
+    /** @brief The corrected fraction of a microsecond in 1/2^32 µs. */
+    uint32_t fraction = 0;
+
+    /** @brief Set once the clock has been advanced. */
+    bool started = false;
+
+    /** @brief Set once a reference sample defined the mapping. */
+    bool referenced = false;
+
+    /** @brief Set once the rate has been measured. */
+    bool locked = false;
+
+    /** @brief The reference time minus the corrected time in µs. */
+    unsigned long referenceOffset = 0;
+
+    /** @brief The reference time of the last rate measurement in µs. */
+    unsigned long lastReference = 0;
+
+    /** @brief The micros() value of the last rate measurement. */
+    unsigned long lastLocal = 0;
+
+    /** @brief Set once a pulse has been received. */
+    bool pulsed = false;
+
+    /** @brief The micros() value of the last pulse. */
+    unsigned long lastPulse = 0;
+
+    /** @brief The reference time of the last pulse in µs. */
+    unsigned long pulseReference = 0;
+
+    /** @brief Advances the corrected clock to a micros() value. */
+    void advance(unsigned long raw);
+
+    /** @brief Processes a reference sample. */
+    void sample(unsigned long reference, unsigned long local);
+
+public:
+    /** @brief Constructs a new AsyncClockDiscipline object.
+     *
+     * @param[in] pulsePeriod The period of the reference pulse in
+     * microseconds. Defaults to 1 s.
+     */
+    AsyncClockDiscipline(unsigned long pulsePeriod = 1000000);
+
+    /** @brief Captures a reference pulse at the current time. Safe to call
+     * from an interrupt handler.
+     *
+     * @return void
+     */
+    void onPulse();
+
+    /** @brief Captures a reference pulse. Safe to call from an interrupt
+     * handler.
+     *
+     * @param[in] local The micros() value of the pulse.
+     *
+     * @return void
+     */
+    void onPulse(unsigned long local);
+
+    /** @brief Supplies the reference time, e.g. from a host message.
+     *
+     * @param[in] reference The reference time in milliseconds.
+     *
+     * @return void
+     */
+    void addReference(unsigned long reference);
+
+    /** @brief Supplies the reference time at a given local time.
+     *
+     * @param[in] reference The reference time in milliseconds.
+     * @param[in] local The micros() value the reference time belongs to.
+     *
+     * @return void
+     */
+    void addReference(unsigned long reference, unsigned long local);
+
+    /** @brief Processes the captured pulses.
+     *
+     * @retval true if a pulse was accepted.
+     * @retval false otherwise.
+     */
+    bool update();
+
+    /** @brief Reads the corrected clock.
+     *
+     * @return The corrected time in milliseconds.
+     */
+    unsigned long getMillis();
+
+    /** @brief Reads the corrected clock.
+     *
+     * @return The corrected time in microseconds.
+     */
+    unsigned long getMicros();
+
+    /** @brief Checks if the rate has been measured.
+     *
+     * @return True once a rate correction is applied.
+     */
+    bool isLocked();
+
+    /** @brief Retrieves the rate correction.
+     *
+     * @return The correction in parts per million, positive if micros()
+     * runs slow.
+     */
+    long getCorrection();
+
+    /** @brief Retrieves the offset that is still being slewed.
+     *
+     * @return The offset in microseconds, positive if the clock is behind
+     * the reference.
+     */
+    long getOffset();
+};
+
+#endif  // _ASYNC_CLOCK_DISCIPLINE_H
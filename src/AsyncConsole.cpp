@@ -0,0 +1,277 @@
+#include "AsyncConsole.h"
+
+static const char NAME_HELP[] PROGMEM = "help";
+static const char NAME_LIST[] PROGMEM = "list";
+static const char NAME_SET[] PROGMEM = "set";
+static const char NAME_PAUSE[] PROGMEM = "pause";
+static const char NAME_RESUME[] PROGMEM = "resume";
+static const char NAME_RESET[] PROGMEM = "reset";
+
+const AsyncConsole::Command AsyncConsole::COMMANDS[] PROGMEM = {
+    {NAME_HELP, AsyncConsole::cmdHelp},
+    {NAME_LIST, AsyncConsole::cmdList},
+    {NAME_SET, AsyncConsole::cmdSet},
+    {NAME_PAUSE, AsyncConsole::cmdPause},
+    {NAME_RESUME, AsyncConsole::cmdResume},
+    {NAME_RESET, AsyncConsole::cmdReset},
+};
+
+/**
+ * @brief Splits the next whitespace-separated word off a string.
+ *
+ * @param[in,out] s The string, advanced past the word.
+ *
+ * @return The word, or nullptr if there is none.
+ */
+static char *nextWord(char *&s) {
+    while (*s == ' ' || *s == '\t') {
+        s++;
+    }
+
+    if (*s == '\0') {
+        return nullptr;
+    }
+
+    char *word = s;
+    while (*s != '\0' && *s != ' ' && *s != '\t') {
+        s++;
+    }
+
+    if (*s != '\0') {
+        *s++ = '\0';
+    }
+
+    return word;
+}
+
+/**
+ * @brief Parses an unsigned decimal number.
+ *
+ * @param[in] word The text to parse.
+ * @param[in] max The largest accepted value.
+ * @param[out] value The parsed value.
+ *
+ * @return `true` if the whole word is a number not above `max`, `false`
+ * otherwise.
+ */
+static bool parseNumber(const char *word, unsigned long max,
+                        unsigned long &value) {
+    if (word == nullptr || *word == '\0') {
+        return false;
+    }
+
+    value = 0;
+    for (; *word != '\0'; word++) {
+        if (*word < '0' || *word > '9') {
+            return false;
+        }
+
+        // Checked before multiplying, so the value cannot wrap.
+        unsigned long digit = *word - '0';
+        if (value > (max - digit) / 10) {
+            return false;
+        }
+
+        value = value * 10 + digit;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Prints a name id as four hex digits with a 0x prefix, the format of
+ * the names map and the telemetry decoder.
+ *
+ * @param[in] out The output.
+ * @param[in] name The name id.
+ */
+static void printName(Print &out, uint16_t name) {
+    out.print('0');
+    out.print('x');
+    for (int shift = 12; shift >= 0; shift -= 4) {
+        uint8_t digit = (name >> shift) & 0x0F;
+        out.print((char)(digit < 10 ? '0' + digit : 'a' + digit - 10));
+    }
+}
+
+/**
+ * @brief Constructs a new AsyncConsole object.
+ *
+ * @param[in] stream The stream to read commands from.
+ * @param[in] scheduler The scheduler whose timers are managed.
+ */
+AsyncConsole::AsyncConsole(Stream &stream, AsyncScheduler &scheduler)
+    : stream(stream), scheduler(scheduler) {}
+
+/**
+ * @brief Processes the characters that are already available.
+ *
+ * The number of characters handled per call is bounded by the buffer size,
+ * so a flood of input cannot stall loop(). Lines that do not fit into the
+ * buffer are dropped as a whole and reported once the line ends.
+ */
+void AsyncConsole::poll() {
+    for (unsigned char n = 0; n < ASYNC_CONSOLE_BUFFER; n++) {
+        if (this->stream.available() <= 0) {
+            return;
+        }
+
+        char c = (char)this->stream.read();
+        if (c == '\r' || c == '\n') {
+            if (this->overflow) {
+                this->stream.println(F("error: line too long"));
+            } else if (this->length > 0) {
+                this->line[this->length] = '\0';
+                this->execute();
+            }
+
+            this->length = 0;
+            this->overflow = false;
+        } else if (this->length < ASYNC_CONSOLE_BUFFER - 1) {
+            this->line[this->length++] = c;
+        } else {
+            this->overflow = true;
+        }
+    }
+}
+
+/**
+ * @brief Looks the first word of the line up in the command table and runs
+ * its handler with the rest of the line.
+ */
+void AsyncConsole::execute() {
+    char *args = this->line;
+    char *name = nextWord(args);
+    if (name == nullptr) {
+        return;
+    }
+
+    for (unsigned char i = 0; i < sizeof(COMMANDS) / sizeof(COMMANDS[0]);
+         i++) {
+        Command command;
+        memcpy_P(&command, &COMMANDS[i], sizeof(command));
+        if (strcmp_P(name, command.name) == 0) {
+            command.handler(*this, args);
+            return;
+        }
+    }
+
+    this->stream.print(F("error: unknown command "));
+    this->stream.println(name);
+}
+
+/**
+ * @brief Parses a slot argument and resolves it to a registered timer.
+ *
+ * @param[in,out] args The remaining arguments, advanced past the slot.
+ *
+ * @return The timer, or nullptr (after printing an error) if the argument
+ * is missing or the slot is empty.
+ */
+AsyncDelay *AsyncConsole::parseSlot(char *&args) {
+    unsigned long slot;
+    AsyncDelay *timer = nullptr;
+    if (parseNumber(nextWord(args), AsyncScheduler::CAPACITY - 1, slot)) {
+        timer = this->scheduler.getTimer(slot);
+    }
+
+    if (timer == nullptr) {
+        this->stream.println(F("error: no such slot"));
+    }
+
+    return timer;
+}
+
+/**
+ * @brief Prints one tab-separated line per registered timer.
+ */
+void AsyncConsole::list() {
+    this->stream.println(
+        F("slot\tname\tinterval\tremaining\tcount\tstate\tfires\tmissed"
+          "\tmaxlate\tcbtime"));
+
+    for (unsigned char i = 0; i < AsyncScheduler::CAPACITY; i++) {
+        AsyncDelay *timer = this->scheduler.getTimer(i);
+        if (timer == nullptr) {
+            continue;
+        }
+
+        const AsyncTimerStats &s = this->scheduler.getStats(i);
+        unsigned long interval = timer->getInterval();
+        unsigned long delta = timer->getDelta();
+        unsigned long remaining = delta < interval ? interval - delta : 0;
+
+        this->stream.print((unsigned int)i);
+        this->stream.print('\t');
+        printName(this->stream, this->scheduler.getName(i));
+        this->stream.print('\t');
+        this->stream.print(interval);
+        this->stream.print('\t');
+        this->stream.print(remaining);
+        this->stream.print('\t');
+        this->stream.print(timer->getCount());
+        this->stream.print('\t');
+        this->stream.print(timer->isPaused() ? F("paused") : F("active"));
+        this->stream.print('\t');
+        this->stream.print(s.fires);
+        this->stream.print('\t');
+        this->stream.print(s.missed);
+        this->stream.print('\t');
+        this->stream.print(s.maxLateness);
+        this->stream.print('\t');
+        this->stream.println(s.callbackTime);
+    }
+}
+
+/**
+ * @brief Prints the list of commands.
+ */
+void AsyncConsole::help() {
+    this->stream.println(F("help | list | set <slot> <ms> | pause <slot> | "
+                           "resume <slot> | reset"));
+}
+
+void AsyncConsole::cmdHelp(AsyncConsole &console, char *) {
+    console.help();
+}
+
+void AsyncConsole::cmdList(AsyncConsole &console, char *) {
+    console.list();
+}
+
+void AsyncConsole::cmdSet(AsyncConsole &console, char *args) {
+    AsyncDelay *timer = console.parseSlot(args);
+    if (timer == nullptr) {
+        return;
+    }
+
+    unsigned long interval;
+    if (!parseNumber(nextWord(args), AsyncDelay::MAX_INTERVAL, interval)) {
+        console.stream.println(F("error: bad interval"));
+        return;
+    }
+
+    timer->setInterval(interval);
+    console.stream.println(F("ok"));
+}
+
+void AsyncConsole::cmdPause(AsyncConsole &console, char *args) {
+    AsyncDelay *timer = console.parseSlot(args);
+    if (timer != nullptr) {
+        timer->pause();
+        console.stream.println(F("ok"));
+    }
+}
+
+void AsyncConsole::cmdResume(AsyncConsole &console, char *args) {
+    AsyncDelay *timer = console.parseSlot(args);
+    if (timer != nullptr) {
+        timer->resume();
+        console.stream.println(F("ok"));
+    }
+}
+
+void AsyncConsole::cmdReset(AsyncConsole &console, char *) {
+    console.scheduler.resetStats();
+    console.stream.println(F("ok"));
+}
@@ -0,0 +1,119 @@
+/**
+ * @file AsyncConsole.h
+ *
+ * @brief Provides a small non-blocking command shell for inspecting and
+ * retuning the timers of an AsyncScheduler at runtime.
+ *
+ * @author boolscope
+ */
+#ifndef _ASYNC_CONSOLE_H
+#define _ASYNC_CONSOLE_H
+
+#include <Arduino.h>
+
+#include "AsyncScheduler.h"
+
+/**
+ * @brief The size of the command line buffer in bytes, including the
+ * terminating zero. Longer lines are rejected.
+ */
+#ifndef ASYNC_CONSOLE_BUFFER
+#define ASYNC_CONSOLE_BUFFER 32
+#endif
+
+/**
+ * @class AsyncConsole
+ * @brief Parses commands from a Stream without blocking loop().
+ *
+ * Every poll() consumes at most one buffer worth of characters that are
+ * already available, so it never waits for input. A command is executed
+ * when a line ending is received. The command table is kept in flash, so
+ * the console only costs its line buffer and two references in RAM, and
+ * nothing at all when it is not instantiated.
+ *
+ * Commands (`<slot>` is the scheduler slot shown by `list`):
+ *
+ * - `help` - lists the commands.
+ * - `list` - prints slot, name id (hex), interval, remaining time, count,
+ *   state and the scheduler statistics of every registered timer.
+ * - `set <slot> <ms>` - changes the interval of a timer; intervals above
+ *   AsyncDelay::MAX_INTERVAL are rejected.
+ * - `pause <slot>` / `resume <slot>` - pauses or resumes a timer.
+ * - `reset` - clears the scheduler statistics.
+ *
+ * @code
+ * AsyncConsole console(Serial, scheduler);
+ *
+ * void loop() {
+ *   scheduler.poll();
+ *   console.poll();
+ * }
+ * @endcode
+ */
+class AsyncConsole {
+private:
+    /** @brief The stream commands are read from and replies written to. */
+    Stream &stream;
+
+    /** @brief The scheduler whose timers are inspected. */
+    AsyncScheduler &scheduler;
+
+    /** @brief The current command line. */
+    char line[ASYNC_CONSOLE_BUFFER];
+
+    /** @brief The number of characters in the line buffer. */
+    unsigned char length = 0;
+
+    /** @brief Set when the current line did not fit into the buffer. */
+    bool overflow = false;
+
+    /** @brief Executes the command in the line buffer. */
+    void execute();
+
+    /** @brief Resolves a slot argument, reporting errors to the stream. */
+    AsyncDelay *parseSlot(char *&args);
+
+    /** @brief Prints the `list` output. */
+    void list();
+
+    /** @brief Prints the `help` output. */
+    void help();
+
+    /** @brief Command handler type used by the table in flash. */
+    typedef void (*Handler)(AsyncConsole &console, char *args);
+
+    /** @brief An entry of the command table. */
+    struct Command {
+        const char *name;
+        Handler handler;
+    };
+
+    static void cmdHelp(AsyncConsole &console, char *args);
+    static void cmdList(AsyncConsole &console, char *args);
+    static void cmdSet(AsyncConsole &console, char *args);
+    static void cmdPause(AsyncConsole &console, char *args);
+    static void cmdResume(AsyncConsole &console, char *args);
+    static void cmdReset(AsyncConsole &console, char *args);
+
+    /** @brief The command table, stored in flash. */
+    static const Command COMMANDS[] PROGMEM;
+
+public:
+    /** @brief Constructs a new AsyncConsole object.
+     *
+     * @param[in] stream The stream to read commands from, e.g. Serial.
+     * @param[in] scheduler The scheduler whose timers are managed.
+     */
+    AsyncConsole(Stream &stream, AsyncScheduler &scheduler);
+
+    /** @brief Processes the characters that are already available.
+     *
+     * Reads at most ASYNC_CONSOLE_BUFFER characters and executes a command
+     * for every complete line. Never waits for input.
+     *
+     * @return void
+     */
+    void poll();
+};
+
+#endif  // _ASYNC_CONSOLE_H
@@ -2,6 +2,8 @@
 
 #include <Arduino.h>
 
+#include "AsyncClock.h"
+
 /**
  * @brief Constructs a new AsyncDelay object and sets its interval.
  *
@@ -36,6 +38,77 @@ void AsyncDelay::setInterval(unsigned long interval) {
     this->resetTime();
 }
 
+/**
+ * @brief Changes the delay interval, treating the running period as
+ * requested by the retime mode.
+ *
+ * @param[in] interval The new delay time in milliseconds.
+ * @param[in] mode How the running period is treated.
+ */
+void AsyncDelay::setInterval(unsigned long interval, RetimeMode mode) {
+    this->setInterval(interval, mode, AsyncClock::read());
+}
+
+/**
+ * @brief Changes the delay interval at the given time, treating the running
+ * period as requested by the retime mode.
+ *
+ * A timer whose old or new interval is zero has no running period to
+ * keep, so it is always reset. Otherwise the pause state is not changed.
+ *
+ * @param[in] interval The new delay time in milliseconds.
+ * @param[in] mode How the running period is treated.
+ * @param[in] now The current time in milliseconds.
+ */
+void AsyncDelay::setInterval(unsigned long interval, RetimeMode mode,
+                             unsigned long now) {
+    unsigned long old = this->interval;
+    if (interval > MAX_INTERVAL) {
+        interval = MAX_INTERVAL;
+    }
+
+    this->interval = interval;
+    if (mode == RETIME_RESET || old == 0 || interval == 0) {
+        this->resetTime(now);
+        return;
+    }
+
+    if (mode == RETIME_KEEP_ELAPSED) {
+        return;
+    }
+
+    // The time left until the old deadline, 0 if it has already passed.
+    unsigned long elapsed = this->getDelta(now);
+    unsigned long remaining = elapsed < old ? old - elapsed : 0;
+
+    if (mode == RETIME_SCALE) {
+        remaining = (unsigned long)((unsigned long long)remaining * interval /
+                                    old);
+    } else if (remaining > interval) {
+        remaining = interval;
+    }
+
+    // Move the start of the period so that it ends `remaining` from now.
+    this->timestamp = now + remaining - interval;
+}
+
+/**
+ * @brief Changes the intervals of several timers against one clock read.
+ *
+ * @param[in,out] timers The timers.
+ * @param[in] intervals The new interval of each timer in milliseconds.
+ * @param[in] count The number of timers.
+ * @param[in] mode How the running periods are treated.
+ */
+void AsyncDelay::setIntervals(AsyncDelay *const *timers,
+                              const unsigned long *intervals, size_t count,
+                              RetimeMode mode) {
+    unsigned long now = AsyncClock::read();
+    for (size_t i = 0; i < count; i++) {
+        timers[i]->setInterval(intervals[i], mode, now);
+    }
+}
+
 /**
  * @brief Pauses the delay timer.
  *
@@ -43,7 +116,7 @@ void AsyncDelay::setInterval(unsigned long interval) {
  * towards the delay interval.
  */
 void AsyncDelay::pause() {
-    this->isPaused = true;
+    this->paused = true;
 }
 
 /**
@@ -53,10 +126,22 @@ void AsyncDelay::pause() {
  * timestamp to the current system time.
  */
 void AsyncDelay::resume() {
-    this->isPaused = false;
+    this->paused = false;
     this->resetTime();
 }
 
+/**
+ * @brief Checks if the delay timer is paused.
+ *
+ * This method returns `true` after pause() has been called and also while
+ * the interval is zero, since such a timer can never become ready.
+ *
+ * @return `true` if the timer is paused, `false` otherwise.
+ */
+bool AsyncDelay::isPaused() {
+    return this->paused;
+}
+
 /**
  * @brief Sets the callback function to be executed when the delay interval is
  * reached.
@@ -114,11 +199,24 @@ unsigned long AsyncDelay::getInterval() {
  * effectively resetting the timer.
  */
 void AsyncDelay::resetTime() {
-    this->timestamp = millis();
+    this->resetTime(AsyncClock::read());
+}
+
+/**
+ * @brief Resets the internal timestamp to the given time.
+ *
+ * Same as resetTime(), but uses a time that has already been read, so
+ * several timers can be reset against a single clock snapshot.
+ *
+ * @param[in] now The current time in milliseconds, as returned by
+ * AsyncClock::read().
+ */
+void AsyncDelay::resetTime(unsigned long now) {
+    this->timestamp = now;
     if (this->interval == 0) {
-        this->isPaused = true;
+        this->paused = true;
     } else {
-        this->isPaused = false;
+        this->paused = false;
     }
 }
 
@@ -134,6 +232,19 @@ void AsyncDelay::resetTime() {
  * @return The elapsed time in milliseconds.
  */
 unsigned long AsyncDelay::getDelta() {
+    return this->getDelta(AsyncClock::read());
+}
+
+/**
+ * @brief Calculates the elapsed time between the last timestamp update and
+ * the given time.
+ *
+ * @param[in] now The current time in milliseconds, as returned by
+ * AsyncClock::read().
+ *
+ * @return The elapsed time in milliseconds.
+ */
+unsigned long AsyncDelay::getDelta(unsigned long now) {
     // The millis method resets to zero when the ULONG_MAX range is reached.
     // Therefore, if the last fixation of time was close to the moment of
     // resetting the delta can get a value with a very large range
@@ -141,7 +252,7 @@ unsigned long AsyncDelay::getDelta() {
     //
     // We can determine the overflow of millis (approximately every 49.7 days) -
     // if millis is less than the timestamp.
-    unsigned long m = millis();
+    unsigned long m = now;
     return m < this->timestamp ? ULONG_MAX - this->timestamp + m
                                : m - this->timestamp;
 }
@@ -171,13 +282,30 @@ unsigned long AsyncDelay::getDelta() {
  * callback function if set), `false` otherwise.
  */
 bool AsyncDelay::isDone() {
+    return this->isDone(AsyncClock::read());
+}
+
+/**
+ * @brief Checks if the delay interval has been reached or exceeded at the
+ * given time.
+ *
+ * Same as isDone(), but uses a time that has already been read, so a batch
+ * of timers can be checked against a single clock snapshot.
+ *
+ * @param[in] now The current time in milliseconds, as returned by
+ * AsyncClock::read().
+ *
+ * @return `true` if the delay interval is reached or exceeded (and invokes the
+ * callback function if set), `false` otherwise.
+ */
+bool AsyncDelay::isDone(unsigned long now) {
     // If the interval is set to zero, the "ready" state can never occur.
-    if (this->isPaused || this->interval == 0) {
+    if (this->paused || this->interval == 0) {
         return false;
     }
 
     // If the loop object is active, then the count is incremented.
-    if (this->getDelta() >= this->interval) {
+    if (this->getDelta(now) >= this->interval) {
         // Increment the count and call the callback function, if it exists.
         this->count++;
 
@@ -217,9 +345,23 @@ bool AsyncDelay::isDone() {
  * callback function if set), `false` otherwise.
  */
 bool AsyncDelay::isReady() {
-    bool result = this->isDone();
+    return this->isReady(AsyncClock::read());
+}
+
+/**
+ * @brief Checks if the delay interval has been reached or exceeded at the
+ * given time and resets the timer to that time if so.
+ *
+ * @param[in] now The current time in milliseconds, as returned by
+ * AsyncClock::read().
+ *
+ * @return `true` if the delay interval is reached or exceeded (and invokes the
+ * callback function if set), `false` otherwise.
+ */
+bool AsyncDelay::isReady(unsigned long now) {
+    bool result = this->isDone(now);
     if (result) {
-        this->resetTime();
+        this->resetTime(now);
     }
 
     return result;
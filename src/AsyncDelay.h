@@ -10,6 +10,7 @@
 #define _ASYNC_DELAY_H
 
 #include <limits.h>
+#include <stddef.h>
 
 /**
  * @brief Type definition for a callback function with no arguments and no
@@ -27,7 +28,7 @@ typedef void (*CallbackFunction)();
  * a single-threaded microcontroller environment.
  */
 class AsyncDelay {
-private:
+protected:
     /** @brief The number of times the AsyncDelay instance has been triggered.
      */
     unsigned long count = 0;
@@ -48,7 +49,7 @@ private:
      * This member variable keeps track of whether the timer is currently
      * paused. By default, it is set to true because the default interval is 0.
      */
-    bool isPaused = true;  // because default interval is 0
+    bool paused = true;  // because default interval is 0
 
     /**
      * @brief Stores the callback function to be invoked when the timer expires.
@@ -65,6 +66,24 @@ public:
     // Maximum allowed interval in milliseconds.
     static const unsigned long MAX_INTERVAL = 36000000;  // 10 hours
 
+    /** @brief Defines how a new interval treats the running period.
+     *
+     * For a period that started at T0 with interval I and elapsed time E at
+     * the moment of the change to the new interval N:
+     *
+     * - RETIME_RESET starts a new period now (deadline now + N).
+     * - RETIME_KEEP_DEADLINE keeps the deadline T0 + I, but never lets it be
+     *   further away than N.
+     * - RETIME_KEEP_ELAPSED keeps T0, so the deadline becomes T0 + N.
+     * - RETIME_SCALE scales the remaining time I - E by N / I.
+     */
+    enum RetimeMode {
+        RETIME_RESET,
+        RETIME_KEEP_DEADLINE,
+        RETIME_KEEP_ELAPSED,
+        RETIME_SCALE
+    };
+
     /** @brief Constructs a new AsyncDelay object.
      *
      * Initializes a new AsyncDelay object and optionally sets the delay
@@ -89,6 +108,39 @@ public:
      */
     void setInterval(unsigned long interval);
 
+    /** @brief Changes the delay interval of a running timer.
+     *
+     * Unlike setInterval(interval), the progress toward the next deadline
+     * can be kept, so a timer that is retuned constantly is not starved.
+     *
+     * @param[in] interval The desired delay time in milliseconds.
+     * @param[in] mode How the running period is treated.
+     */
+    void setInterval(unsigned long interval, RetimeMode mode);
+
+    /** @brief Changes the delay interval of a running timer at the given
+     * time.
+     *
+     * @param[in] interval The desired delay time in milliseconds.
+     * @param[in] mode How the running period is treated.
+     * @param[in] now The current time in milliseconds, as returned by
+     * AsyncClock::read().
+     */
+    void setInterval(unsigned long interval, RetimeMode mode,
+                     unsigned long now);
+
+    /** @brief Changes the intervals of several timers against one clock
+     * read.
+     *
+     * @param[in,out] timers The timers.
+     * @param[in] intervals The new interval of each timer in milliseconds.
+     * @param[in] count The number of timers.
+     * @param[in] mode How the running periods are treated.
+     */
+    static void setIntervals(AsyncDelay *const *timers,
+                             const unsigned long *intervals, size_t count,
+                             RetimeMode mode);
+
     /**
      * @brief Pauses the timer.
      *
@@ -105,6 +157,15 @@ public:
      */
     void resume();
 
+    /**
+     * @brief Checks if the timer is paused.
+     *
+     * A timer is also paused while its interval is zero.
+     *
+     * @return True if the timer is paused, false otherwise.
+     */
+    bool isPaused();
+
     /**
      * @brief Sets the callback function for the timer.
      *
@@ -145,18 +206,29 @@ public:
 
     /** @brief Resets the internal timestamp to the current time.
      *
-     * Updates the internal timestamp with the current time from millis().
+     * Updates the internal timestamp with the current time from
+     * AsyncClock::read().
      * This effectively resets any counting towards the next activation period.
      *
      * @return void
      */
     void resetTime();
 
+    /** @brief Resets the internal timestamp to the given time.
+     *
+     * @param[in] now The current time in milliseconds, as returned by
+     * AsyncClock::read(). Lets several timers share one clock snapshot.
+     *
+     * @return void
+     */
+    void resetTime(unsigned long now);
+
     /** @brief Calculates the time elapsed since the last reset.
      *
      * This function returns the difference, in milliseconds, between the
-     * current system time (as obtained by millis()) and the internal timestamp
-     * set by the last call to resetTime() or during object initialization.
+     * current system time (as obtained by AsyncClock::read()) and the
+     * internal timestamp set by the last call to resetTime() or during
+     * object initialization.
      * This can be useful for understanding how close the object is to
      * transitioning to its 'ready' or 'done' state.
      *
@@ -164,6 +236,16 @@ public:
      */
     unsigned long getDelta();
 
+    /** @brief Calculates the time elapsed between the last reset and the
+     * given time.
+     *
+     * @param[in] now The current time in milliseconds, as returned by
+     * AsyncClock::read(). Lets several timers share one clock snapshot.
+     *
+     * @return The time difference in milliseconds.
+     */
+    unsigned long getDelta(unsigned long now);
+
     /** @brief Checks if the loop object's delay interval has expired.
      *
      * @retval true if the loop object's delay interval has expired.
@@ -189,6 +271,18 @@ public:
      */
     bool isDone();
 
+    /** @brief Checks if the delay interval has expired at the given time.
+     *
+     * Same as isDone(), but does not read the clock.
+     *
+     * @param[in] now The current time in milliseconds, as returned by
+     * AsyncClock::read(). Lets several timers share one clock snapshot.
+     *
+     * @retval true if the loop object's delay interval has expired.
+     * @retval false otherwise.
+     */
+    bool isDone(unsigned long now);
+
     /** @brief Checks if the loop object is ready to execute its task.
      *
      * @retval true if the loop object's delay interval has expired.
@@ -223,6 +317,19 @@ public:
      */
     bool isReady();
 
+    /** @brief Checks if the loop object is ready at the given time.
+     *
+     * Same as isReady(), but does not read the clock; when the timer fires
+     * it is reset to `now`.
+     *
+     * @param[in] now The current time in milliseconds, as returned by
+     * AsyncClock::read(). Lets several timers share one clock snapshot.
+     *
+     * @retval true if the loop object's delay interval has expired.
+     * @retval false otherwise.
+     */
+    bool isReady(unsigned long now);
+
     /** @brief Gets the number of times the loop object has become active.
      *
      * This function returns the count of times the object's delay interval has
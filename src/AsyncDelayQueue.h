@@ -0,0 +1,369 @@
+/**
+ * @file AsyncDelayQueue.h
+ *
+ * @brief Provides a fixed-capacity queue that releases items after a
+ * per-item delay.
+ *
+ * @author boolscope
+ */
+#ifndef _ASYNC_DELAY_QUEUE_H
+#define _ASYNC_DELAY_QUEUE_H
+
+#include <Arduino.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__AVR__)
+#include <new.h>
+#else
+#include <new>
+#include <type_traits>
+#endif
+
+#include "AsyncClock.h"
+#include "AsyncDelay.h"
+
+/**
+ * @class AsyncDelayQueue
+ * @brief Holds up to Capacity items and pops them in deadline order.
+ *
+ * Items are constructed in place in a pool of raw storage by emplace(), so
+ * large items are never copied, and stay at the same address until they are
+ * popped. The pool slots are ordered by a binary min-heap of indices, so
+ * inserting and popping are O(log n) and only the small indices move.
+ *
+ * Deadlines use the AsyncDelay time base and are compared with wrapping
+ * arithmetic, so the queue keeps working across the millis() rollover.
+ * Delays are clamped to AsyncDelay::MAX_INTERVAL. Items with the same
+ * deadline are popped in the order they were queued.
+ *
+ * @code
+ * struct Move { uint8_t axis; long steps; };
+ * AsyncDelayQueue<Move, 16> moves;
+ *
+ * void onCommand(uint8_t axis, long steps, unsigned long after) {
+ *   moves.emplace(after, axis, steps);  // built in the queue
+ * }
+ *
+ * void loop() {
+ *   Move *m;
+ *   while ((m = moves.peek()) != nullptr) {
+ *     stepper[m->axis].move(m->steps);
+ *     moves.pop();
+ *   }
+ * }
+ * @endcode
+ *
+ * @tparam T The item type.
+ * @tparam Capacity The maximum number of pending items.
+ */
+template <typename T, size_t Capacity>
+class AsyncDelayQueue {
+private:
+    /** @brief Raw, suitably aligned storage for the items. */
+    alignas(T) uint8_t storage[Capacity][sizeof(T)];
+
+    /** @brief The deadline of each pool slot in milliseconds. */
+    unsigned long deadlines[Capacity];
+
+    /** @brief The queueing order of each pool slot, breaks deadline ties. */
+    unsigned long sequences[Capacity];
+
+    /** @brief The sequence number of the next queued item. */
+    unsigned long sequence = 0;
+
+    /** @brief The min-heap of pool slots, ordered by deadline. */
+    size_t heap[Capacity];
+
+    /** @brief A stack of unused pool slots. */
+    size_t freeList[Capacity];
+
+    /** @brief The number of unused pool slots. */
+    size_t freeCount = Capacity;
+
+    /** @brief The number of pending items. */
+    size_t count = 0;
+
+    /** @brief Returns the item in a pool slot. */
+    T *item(size_t slot) {
+        return reinterpret_cast<T *>(this->storage[slot]);
+    }
+
+    /** @brief Selects how construct() builds an item. */
+    template <bool Constructible>
+    struct Syntax {};
+
+#if defined(__AVR__)
+    // AVR has no <type_traits>, so constructibility is probed directly.
+
+    /** @brief Names a value of type U in unevaluated expressions. */
+    template <typename U>
+    static U &&declval();
+
+    /** @brief Syntax<true> if T has a constructor taking A. */
+    template <typename... A>
+    static Syntax<true> probe(decltype(::new ((void *)0)
+                                           T(declval<A>()...)));
+
+    /** @brief Syntax<false> otherwise. */
+    template <typename... A>
+    static Syntax<false> probe(...);
+
+    /** @brief The syntax that builds a T from A. */
+    template <typename... A>
+    using SyntaxFor = decltype(probe<A...>(nullptr));
+#else
+    /** @brief The syntax that builds a T from A. */
+    template <typename... A>
+    using SyntaxFor = Syntax<std::is_constructible<T, A...>::value>;
+#endif
+
+    /** @brief Calls a constructor of T, converting the arguments. */
+    template <typename... A>
+    static T *construct(void *p, Syntax<true>, A &&...args) {
+        return new (p) T(static_cast<A &&>(args)...);
+    }
+
+    /** @brief Initializes an aggregate T from its member values. */
+    template <typename... A>
+    static T *construct(void *p, Syntax<false>, A &&...args) {
+        return new (p) T{static_cast<A &&>(args)...};
+    }
+
+    /** @brief Checks if slot a is due before slot b, or was queued first
+     * with the same deadline. */
+    bool before(size_t a, size_t b) {
+        long d = (long)(this->deadlines[a] - this->deadlines[b]);
+        if (d != 0) {
+            return d < 0;
+        }
+
+        return (long)(this->sequences[a] - this->sequences[b]) < 0;
+    }
+
+    /** @brief Moves the heap entry at position i towards the root. */
+    void siftUp(size_t i) {
+        size_t slot = this->heap[i];
+        while (i > 0) {
+            size_t parent = (i - 1) / 2;
+            if (!this->before(slot, this->heap[parent])) {
+                break;
+            }
+
+            this->heap[i] = this->heap[parent];
+            i = parent;
+        }
+
+        this->heap[i] = slot;
+    }
+
+    /** @brief Moves the heap entry at position i towards the leaves. */
+    void siftDown(size_t i) {
+        size_t slot = this->heap[i];
+        for (;;) {
+            size_t child = 2 * i + 1;
+            if (child >= this->count) {
+                break;
+            }
+
+            if (child + 1 < this->count &&
+                this->before(this->heap[child + 1], this->heap[child])) {
+                child++;
+            }
+
+            if (!this->before(this->heap[child], slot)) {
+                break;
+            }
+
+            this->heap[i] = this->heap[child];
+            i = child;
+        }
+
+        this->heap[i] = slot;
+    }
+
+public:
+    // The maximum number of pending items.
+    static const size_t CAPACITY = Capacity;
+
+    /** @brief Constructs a new, empty AsyncDelayQueue object. */
+    AsyncDelayQueue() {
+        for (size_t i = 0; i < Capacity; i++) {
+            this->freeList[i] = Capacity - 1 - i;
+        }
+    }
+
+    /** @brief Destroys all pending items. */
+    ~AsyncDelayQueue() {
+        this->clear();
+    }
+
+    AsyncDelayQueue(const AsyncDelayQueue &) = delete;
+    AsyncDelayQueue &operator=(const AsyncDelayQueue &) = delete;
+
+    /** @brief Returns the number of pending items.
+     *
+     * @return The number of pending items.
+     */
+    size_t size() {
+        return this->count;
+    }
+
+    /** @brief Checks if no more items can be queued.
+     *
+     * @return True if the queue is full.
+     */
+    bool isFull() {
+        return this->count == Capacity;
+    }
+
+    /** @brief Constructs an item in place that is due at a deadline.
+     *
+     * An item with a matching constructor is built with it, so the
+     * arguments convert as in a direct call. Otherwise the item is
+     * list-initialized, so an aggregate such as a plain message struct is
+     * built from its member values; these must not narrow.
+     *
+     * @param[in] deadline The absolute deadline in milliseconds. It must be
+     * less than AsyncDelay::MAX_INTERVAL away from the other deadlines.
+     * @param[in] args The constructor arguments or the members of T.
+     *
+     * @return The new item, or nullptr if the queue is full.
+     */
+    template <typename... Args>
+    T *emplaceAt(unsigned long deadline, Args &&...args) {
+        if (this->count == Capacity) {
+            return nullptr;
+        }
+
+        size_t slot = this->freeList[--this->freeCount];
+        T *p = construct(this->storage[slot], SyntaxFor<Args...>(),
+                         static_cast<Args &&>(args)...);
+        this->deadlines[slot] = deadline;
+        this->sequences[slot] = this->sequence++;
+        this->heap[this->count] = slot;
+        this->siftUp(this->count++);
+
+        return p;
+    }
+
+    /** @brief Constructs an item in place that is due after a delay.
+     *
+     * @param[in] delay The delay in milliseconds, counted from
+     * AsyncClock::read().
+     * @param[in] args The constructor arguments or the members of T.
+     *
+     * @return The new item, or nullptr if the queue is full.
+     */
+    template <typename... Args>
+    T *emplace(unsigned long delay, Args &&...args) {
+        if (delay > AsyncDelay::MAX_INTERVAL) {
+            delay = AsyncDelay::MAX_INTERVAL;
+        }
+
+        return this->emplaceAt(AsyncClock::read() + delay,
+                               static_cast<Args &&>(args)...);
+    }
+
+    /** @brief Copies an item into the queue.
+     *
+     * @param[in] value The item.
+     * @param[in] delay The delay in milliseconds.
+     * @param[in] now The current time in milliseconds.
+     *
+     * @retval true if the item was queued.
+     * @retval false if the queue is full.
+     */
+    bool push(const T &value, unsigned long delay, unsigned long now) {
+        if (delay > AsyncDelay::MAX_INTERVAL) {
+            delay = AsyncDelay::MAX_INTERVAL;
+        }
+
+        return this->emplaceAt(now + delay, value) != nullptr;
+    }
+
+    /** @brief Copies an item into the queue.
+     *
+     * @param[in] value The item.
+     * @param[in] delay The delay in milliseconds.
+     *
+     * @retval true if the item was queued.
+     * @retval false if the queue is full.
+     */
+    bool push(const T &value, unsigned long delay) {
+        return this->push(value, delay, AsyncClock::read());
+    }
+
+    /** @brief Returns the item with the earliest deadline if it is due.
+     *
+     * The item stays queued until pop() is called.
+     *
+     * @param[in] now The current time in milliseconds.
+     *
+     * @return The item, or nullptr if no item is due.
+     */
+    T *peek(unsigned long now) {
+        if (this->count == 0 ||
+            (long)(now - this->deadlines[this->heap[0]]) < 0) {
+            return nullptr;
+        }
+
+        return this->item(this->heap[0]);
+    }
+
+    /** @brief Returns the item with the earliest deadline if it is due.
+     *
+     * @return The item, or nullptr if no item is due.
+     */
+    T *peek() {
+        return this->peek(AsyncClock::read());
+    }
+
+    /** @brief Calculates the time until the earliest item is due.
+     *
+     * @param[in] now The current time in milliseconds.
+     *
+     * @return The time in milliseconds, 0 if an item is due, or
+     * AsyncDelay::MAX_INTERVAL if the queue is empty.
+     */
+    unsigned long getRemaining(unsigned long now) {
+        if (this->count == 0) {
+            return AsyncDelay::MAX_INTERVAL;
+        }
+
+        long remaining = (long)(this->deadlines[this->heap[0]] - now);
+        return remaining > 0 ? (unsigned long)remaining : 0;
+    }
+
+    /** @brief Destroys and removes the item with the earliest deadline,
+     * whether it is due or not.
+     *
+     * @retval true if an item was removed.
+     * @retval false if the queue is empty.
+     */
+    bool pop() {
+        if (this->count == 0) {
+            return false;
+        }
+
+        size_t slot = this->heap[0];
+        this->item(slot)->~T();
+        this->freeList[this->freeCount++] = slot;
+        this->count--;
+
+        if (this->count != 0) {
+            this->heap[0] = this->heap[this->count];
+            this->siftDown(0);
+        }
+
+        return true;
+    }
+
+    /** @brief Destroys all pending items. */
+    void clear() {
+        while (this->pop()) {
+        }
+    }
+};
+
+#endif  // _ASYNC_DELAY_QUEUE_H
@@ -0,0 +1,211 @@
+#include "AsyncEnergyModel.h"
+
+#include <Arduino.h>
+
+/**
+ * @brief Constructs a new AsyncEnergyModel object.
+ *
+ * @param[in] scheduler The scheduler whose callbacks count as active.
+ * @param[in] currents The current of each state in microamperes.
+ * @param[in] count The number of entries, clamped to STATES.
+ */
+AsyncEnergyModel::AsyncEnergyModel(AsyncScheduler &scheduler,
+                                   const unsigned long *currents,
+                                   uint8_t count)
+    : scheduler(scheduler),
+      currents(currents),
+      count(count > STATES ? STATES : count) {}
+
+/**
+ * @brief Reports time spent in a sleep mode and a wakeup after it.
+ *
+ * @param[in] mode The sleep mode index.
+ * @param[in] duration The sleep time in microseconds.
+ */
+void AsyncEnergyModel::addSleep(uint8_t mode, unsigned long duration) {
+    if (SLEEP + mode >= STATES) {
+        return;
+    }
+
+    this->times[SLEEP + mode] += duration;
+    this->pendingSleep += duration;
+    this->wakeCount++;
+}
+
+/**
+ * @brief Accounts the time since the last update.
+ */
+void AsyncEnergyModel::update() {
+    this->update(micros());
+}
+
+/**
+ * @brief Accounts the time since the last update at the given time.
+ *
+ * The elapsed time minus the callback time and the reported sleep time is
+ * counted as idle. Every slot that fired since the last update is charged
+ * with the current wakeup, unless it already was. The statistics grow
+ * modulo 2^32 and restart from zero after resetStats() or a reused slot.
+ *
+ * @param[in] now The current time in microseconds.
+ */
+void AsyncEnergyModel::update(unsigned long now) {
+    unsigned long long elapsed = this->started ? now - this->lastUpdate : 0;
+    this->lastUpdate = now;
+    this->started = true;
+
+    uint8_t generation = this->scheduler.getStatsGeneration();
+    bool reset = generation != this->statsGeneration;
+    this->statsGeneration = generation;
+
+    unsigned long long active = 0;
+    for (unsigned char i = 0; i < AsyncScheduler::CAPACITY; i++) {
+        this->sync(i);
+        if (reset) {
+            this->callbackTimes[i] = 0;
+            this->fires[i] = 0;
+        }
+
+        const AsyncTimerStats &s = this->scheduler.getStats(i);
+        active += s.callbackTime - this->callbackTimes[i];
+        this->callbackTimes[i] = s.callbackTime;
+
+        if (this->wakeCount != this->charged[i] &&
+            s.fires != this->fires[i] &&
+            this->scheduler.getTimer(i) != nullptr) {
+            this->wakeups[i]++;
+            this->charged[i] = this->wakeCount;
+        }
+
+        this->fires[i] = s.fires;
+    }
+
+    this->times[ACTIVE] += active;
+
+    unsigned long long busy = active + this->pendingSleep;
+    this->pendingSleep = 0;
+    if (elapsed > busy) {
+        this->times[IDLE] += elapsed - busy;
+    }
+}
+
+/**
+ * @brief Drops the state of a slot that add() has reused.
+ *
+ * The wakeups belonged to the previous timer, and the new timer's
+ * statistics start from zero.
+ *
+ * @param[in] index The slot index.
+ */
+void AsyncEnergyModel::sync(unsigned char index) {
+    uint8_t generation = this->scheduler.getGeneration(index);
+    if (generation == this->generations[index]) {
+        return;
+    }
+
+    this->generations[index] = generation;
+    this->callbackTimes[index] = 0;
+    this->fires[index] = 0;
+    this->wakeups[index] = 0;
+    this->charged[index] = 0;
+}
+
+/**
+ * @brief Clears all accounted time and wakeups.
+ */
+void AsyncEnergyModel::reset() {
+    for (uint8_t s = 0; s < STATES; s++) {
+        this->times[s] = 0;
+    }
+
+    for (unsigned char i = 0; i < AsyncScheduler::CAPACITY; i++) {
+        this->wakeups[i] = 0;
+        this->charged[i] = 0;
+    }
+
+    this->pendingSleep = 0;
+    this->wakeCount = 0;
+    this->started = false;
+}
+
+/**
+ * @brief Retrieves the time spent in a state.
+ *
+ * @param[in] state The state.
+ *
+ * @return The time in milliseconds.
+ */
+unsigned long AsyncEnergyModel::getTime(uint8_t state) {
+    return state < STATES ? (unsigned long)(this->times[state] / 1000) : 0;
+}
+
+/**
+ * @brief Retrieves the total accounted time.
+ *
+ * @return The time in milliseconds.
+ */
+unsigned long AsyncEnergyModel::getTotalTime() {
+    unsigned long long total = 0;
+    for (uint8_t s = 0; s < STATES; s++) {
+        total += this->times[s];
+    }
+
+    return (unsigned long)(total / 1000);
+}
+
+/**
+ * @brief Calculates the time-weighted average current.
+ *
+ * States without a current in the table count as 0 µA.
+ *
+ * @return The current in microamperes, 0 before any time was accounted.
+ */
+unsigned long AsyncEnergyModel::getAverageCurrent() {
+    unsigned long long total = 0;
+    unsigned long long charge = 0;  // in µA * ms
+    for (uint8_t s = 0; s < STATES; s++) {
+        unsigned long long ms = this->times[s] / 1000;
+        total += ms;
+        if (s < this->count) {
+            charge += ms * this->currents[s];
+        }
+    }
+
+    return total == 0 ? 0 : (unsigned long)(charge / total);
+}
+
+/**
+ * @brief Estimates the battery life at the average current.
+ *
+ * @param[in] capacity The battery capacity in milliampere-hours.
+ *
+ * @return The battery life in hours, ULONG_MAX if no current is drawn.
+ */
+unsigned long AsyncEnergyModel::getBatteryLife(unsigned long capacity) {
+    unsigned long current = this->getAverageCurrent();
+    if (current == 0) {
+        return ULONG_MAX;
+    }
+
+    return (unsigned long)((unsigned long long)capacity * 1000 / current);
+}
+
+/**
+ * @brief Retrieves the number of reported wakeups.
+ *
+ * @return The number of wakeups.
+ */
+unsigned long AsyncEnergyModel::getWakeups() {
+    return this->wakeCount;
+}
+
+/**
+ * @brief Retrieves the wakeups charged to a scheduler slot.
+ *
+ * @param[in] index The slot index, must be less than CAPACITY.
+ *
+ * @return The number of wakeups after which the slot fired.
+ */
+unsigned long AsyncEnergyModel::getWakeups(unsigned char index) {
+    return this->wakeups[index];
+}
@@ -0,0 +1,203 @@
+/**
+ * @file AsyncEnergyModel.h
+ *
+ * @brief Provides an energy model that estimates the average current and the
+ * battery life of a timer configuration.
+ *
+ * @author boolscope
+ */
+#ifndef _ASYNC_ENERGY_MODEL_H
+#define _ASYNC_ENERGY_MODEL_H
+
+#include <stdint.h>
+
+#include "AsyncPowerManager.h"
+#include "AsyncScheduler.h"
+
+/**
+ * @class AsyncEnergyModel
+ * @brief Splits the elapsed time into power states and weights it with the
+ * current drawn in each state.
+ *
+ * The states are ACTIVE (running timer callbacks), IDLE (awake, but not in
+ * a callback) and one state per sleep mode, starting at SLEEP. The model is
+ * given the current of every state in microamperes and learns the time
+ * spent in each of them:
+ *
+ * - the active time is the growth of the scheduler's callback time,
+ * - sleep time is reported with addSleep(), typically from the enter
+ *   functions of the AsyncPowerManager modes,
+ * - the rest of the elapsed time between two update() calls is idle.
+ *
+ * Every reported sleep ends with a wakeup. Each timer that fires before the
+ * next sleep is charged with that wakeup (once), so getWakeups() shows
+ * which timers keep the system awake.
+ *
+ * The model runs on the target as well, but it is most useful on the host
+ * with hostSimulateClock(): a simulated day takes a fraction of a second,
+ * so intervals and sleep settings can be compared before touching
+ * hardware (see extras/energy).
+ *
+ * @code
+ * // active, idle, idle sleep, power down in microamperes
+ * const unsigned long currents[] = {5000, 1500, 800, 5};
+ * AsyncEnergyModel energy(scheduler, currents, 4);
+ *
+ * void powerDown(unsigned long us) {
+ *   hostAdvanceClock(us);
+ *   energy.addSleep(1, us);
+ * }
+ *
+ * void loop() {
+ *   scheduler.poll();
+ *   energy.update();
+ *   power.sleep();
+ * }
+ * @endcode
+ */
+class AsyncEnergyModel {
+public:
+    // The state while timer callbacks run.
+    static const uint8_t ACTIVE = 0;
+
+    // The state while the CPU is awake without work.
+    static const uint8_t IDLE = 1;
+
+    // The state of the first sleep mode; mode i is SLEEP + i.
+    static const uint8_t SLEEP = 2;
+
+    // The number of states.
+    static const uint8_t STATES = SLEEP + ASYNC_SLEEP_MODES;
+
+private:
+    /** @brief The scheduler whose callbacks count as active time. */
+    AsyncScheduler &scheduler;
+
+    /** @brief The current of each state in microamperes. */
+    const unsigned long *currents;
+
+    /** @brief The number of states with a current. */
+    uint8_t count;
+
+    /** @brief The time spent in each state in microseconds. */
+    unsigned long long times[STATES] = {};
+
+    /** @brief The sleep time reported since the last update. */
+    unsigned long long pendingSleep = 0;
+
+    /** @brief The time of the last update in microseconds. */
+    unsigned long lastUpdate = 0;
+
+    /** @brief Set once the model has a reference time. */
+    bool started = false;
+
+    /** @brief The number of reported wakeups. */
+    unsigned long wakeCount = 0;
+
+    /** @brief The callback time of each slot at the last update. */
+    unsigned long callbackTimes[AsyncScheduler::CAPACITY] = {};
+
+    /** @brief The fire count of each slot at the last update. */
+    unsigned long fires[AsyncScheduler::CAPACITY] = {};
+
+    /** @brief The wakeups charged to each slot. */
+    unsigned long wakeups[AsyncScheduler::CAPACITY] = {};
+
+    /** @brief The wakeup each slot was last charged with. */
+    unsigned long charged[AsyncScheduler::CAPACITY] = {};
+
+    /** @brief The scheduler generation each slot's state belongs to. */
+    uint8_t generations[AsyncScheduler::CAPACITY] = {};
+
+    /** @brief The scheduler statistics generation of the baselines. */
+    uint8_t statsGeneration = 0;
+
+    /** @brief Drops the state of a slot that add() has reused. */
+    void sync(unsigned char index);
+
+public:
+    /** @brief Constructs a new AsyncEnergyModel object.
+     *
+     * @param[in] scheduler The scheduler whose callbacks count as active.
+     * @param[in] currents The current of each state in microamperes:
+     * ACTIVE, IDLE, then one per sleep mode. The table is not copied.
+     * @param[in] count The number of entries, at most STATES.
+     */
+    AsyncEnergyModel(AsyncScheduler &scheduler, const unsigned long *currents,
+                     uint8_t count);
+
+    /** @brief Reports time spent in a sleep mode and a wakeup after it.
+     *
+     * @param[in] mode The sleep mode index.
+     * @param[in] duration The sleep time in microseconds.
+     *
+     * @return void
+     */
+    void addSleep(uint8_t mode, unsigned long duration);
+
+    /** @brief Accounts the time since the last update.
+     *
+     * Call it after every scheduler poll.
+     *
+     * @return void
+     */
+    void update();
+
+    /** @brief Accounts the time since the last update at the given time.
+     *
+     * @param[in] now The current time in microseconds.
+     *
+     * @return void
+     */
+    void update(unsigned long now);
+
+    /** @brief Clears all accounted time and wakeups.
+     *
+     * @return void
+     */
+    void reset();
+
+    /** @brief Retrieves the time spent in a state.
+     *
+     * @param[in] state The state, ACTIVE, IDLE or SLEEP + mode.
+     *
+     * @return The time in milliseconds.
+     */
+    unsigned long getTime(uint8_t state);
+
+    /** @brief Retrieves the total accounted time.
+     *
+     * @return The time in milliseconds.
+     */
+    unsigned long getTotalTime();
+
+    /** @brief Calculates the average current.
+     *
+     * @return The current in microamperes.
+     */
+    unsigned long getAverageCurrent();
+
+    /** @brief Estimates the battery life at the average current.
+     *
+     * @param[in] capacity The battery capacity in milliampere-hours.
+     *
+     * @return The battery life in hours.
+     */
+    unsigned long getBatteryLife(unsigned long capacity);
+
+    /** @brief Retrieves the number of reported wakeups.
+     *
+     * @return The number of wakeups.
+     */
+    unsigned long getWakeups();
+
+    /** @brief Retrieves the wakeups charged to a scheduler slot.
+     *
+     * @param[in] index The slot index, must be less than CAPACITY.
+     *
+     * @return The number of wakeups after which the slot fired.
+     */
+    unsigned long getWakeups(unsigned char index);
+};
+
+#endif  // _ASYNC_ENERGY_MODEL_H
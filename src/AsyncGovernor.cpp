@@ -0,0 +1,216 @@
+#include "AsyncGovernor.h"
+
+#include <Arduino.h>
+
+#include "AsyncClock.h"
+
+/**
+ * @brief Constructs a new AsyncGovernor object.
+ *
+ * @param[in] scheduler The scheduler whose timers are governed.
+ * @param[in] window The measurement window in milliseconds.
+ * @param[in] high The high watermark in percent.
+ * @param[in] low The low watermark in percent.
+ */
+AsyncGovernor::AsyncGovernor(AsyncScheduler &scheduler, unsigned long window,
+                             uint8_t high, uint8_t low)
+    : scheduler(scheduler),
+      window(window == 0 ? 1 : window),
+      high(high),
+      low(low < high ? low : high) {}
+
+/**
+ * @brief Sets the criticality class of a registered timer.
+ *
+ * @param[in] timer The timer, registered with the scheduler.
+ * @param[in] cls The class, clamped to MAX_CLASS.
+ * @param[in] maxStretch The largest stretch factor, at least 1.
+ *
+ * @return `true` if the class was set, `false` if the timer is not
+ * registered.
+ */
+bool AsyncGovernor::setClass(AsyncDelay &timer, uint8_t cls,
+                             uint8_t maxStretch) {
+    int index = this->scheduler.indexOf(timer);
+    if (index < 0) {
+        return false;
+    }
+
+    this->sync(index);
+
+    // Give a stretched timer its base interval back before releasing it.
+    if (this->classes[index] != 0 && cls == 0) {
+        timer.setInterval(this->bases[index], AsyncDelay::RETIME_KEEP_ELAPSED);
+    }
+
+    if (this->classes[index] == 0) {
+        this->bases[index] = timer.getInterval();
+    }
+
+    this->classes[index] = cls > MAX_CLASS ? MAX_CLASS : cls;
+    this->limits[index] = maxStretch == 0 ? 1 : maxStretch;
+    this->apply(AsyncClock::read());
+    return true;
+}
+
+/**
+ * @brief Adds busy time that the scheduler does not see, e.g. work done
+ * directly in loop().
+ *
+ * @param[in] time The busy time in microseconds.
+ */
+void AsyncGovernor::addBusyTime(unsigned long time) {
+    this->busyTime += time;
+}
+
+/**
+ * @brief Measures the utilization once per window and adjusts the level.
+ *
+ * @return `true` if the level has changed.
+ */
+bool AsyncGovernor::update() {
+    return this->update(AsyncClock::read());
+}
+
+/**
+ * @brief Measures the utilization at the given time and adjusts the level.
+ *
+ * The callback time of a window is the growth of every slot's
+ * AsyncTimerStats::callbackTime since the previous window, modulo 2^32 so a
+ * wrapping counter is still measured correctly. After resetStats() or a
+ * reused slot the counter starts again from zero. The utilization is
+ * relative to the measured length of the window, so a late update() does
+ * not inflate it.
+ *
+ * @param[in] now The current time in milliseconds.
+ *
+ * @return `true` if the level has changed.
+ */
+bool AsyncGovernor::update(unsigned long now) {
+    unsigned long elapsed = this->window.getDelta(now);
+    if (!this->window.isReady(now)) {
+        return false;
+    }
+
+    unsigned long busy = this->busyTime;
+    this->busyTime = 0;
+
+    uint8_t generation = this->scheduler.getStatsGeneration();
+    bool reset = generation != this->statsGeneration;
+    this->statsGeneration = generation;
+
+    for (unsigned char i = 0; i < AsyncScheduler::CAPACITY; i++) {
+        this->sync(i);
+        if (reset) {
+            this->callbackTimes[i] = 0;
+        }
+
+        unsigned long time = this->scheduler.getStats(i).callbackTime;
+        busy += time - this->callbackTimes[i];
+        this->callbackTimes[i] = time;
+    }
+
+    unsigned long long length = (unsigned long long)elapsed * 1000;
+    if (length == 0) {
+        length = 1;
+    }
+
+    unsigned long long percent = (unsigned long long)busy * 100 / length;
+    this->utilization = percent > 100 ? 100 : (uint8_t)percent;
+
+    uint8_t previous = this->level;
+    if (this->utilization > this->high && this->level < MAX_LEVEL) {
+        this->level++;
+    } else if (this->utilization < this->low && this->level > 0) {
+        this->level--;
+    }
+
+    if (this->level == previous) {
+        return false;
+    }
+
+    this->apply(now);
+    return true;
+}
+
+/**
+ * @brief Drops the level to 0 and restores all base intervals.
+ */
+void AsyncGovernor::restore() {
+    this->level = 0;
+    this->apply(AsyncClock::read());
+}
+
+/**
+ * @brief Retrieves the current stretch level.
+ *
+ * @return The level.
+ */
+uint8_t AsyncGovernor::getLevel() {
+    return this->level;
+}
+
+/**
+ * @brief Retrieves the utilization of the last window.
+ *
+ * @return The utilization in percent.
+ */
+uint8_t AsyncGovernor::getUtilization() {
+    return this->utilization;
+}
+
+/**
+ * @brief Drops the state of a slot that add() has reused.
+ *
+ * The class belonged to the previous timer, and the new timer's statistics
+ * start from zero.
+ *
+ * @param[in] index The slot index.
+ */
+void AsyncGovernor::sync(unsigned char index) {
+    uint8_t generation = this->scheduler.getGeneration(index);
+    if (generation == this->generations[index]) {
+        return;
+    }
+
+    this->generations[index] = generation;
+    this->classes[index] = 0;
+    this->callbackTimes[index] = 0;
+}
+
+/**
+ * @brief Retimes all managed timers to the current level.
+ *
+ * The stretch factor is kept in quarters: 4 + level * class, capped at
+ * 4 * maxStretch.
+ *
+ * @param[in] now The current time in milliseconds.
+ */
+void AsyncGovernor::apply(unsigned long now) {
+    for (unsigned char i = 0; i < AsyncScheduler::CAPACITY; i++) {
+        this->sync(i);
+
+        AsyncDelay *timer = this->scheduler.getTimer(i);
+        if (timer == nullptr || this->classes[i] == 0) {
+            continue;
+        }
+
+        unsigned long quarters = 4 + (unsigned long)this->level *
+                                         this->classes[i];
+        unsigned long limit = 4 * (unsigned long)this->limits[i];
+        if (quarters > limit) {
+            quarters = limit;
+        }
+
+        unsigned long long interval =
+            (unsigned long long)this->bases[i] * quarters / 4;
+        if (interval > AsyncDelay::MAX_INTERVAL) {
+            interval = AsyncDelay::MAX_INTERVAL;
+        }
+
+        if (interval != timer->getInterval()) {
+            timer->setInterval((unsigned long)interval,
+                               AsyncDelay::RETIME_KEEP_ELAPSED, now);
+        }
+    }
+}
@@ -0,0 +1,180 @@
+/**
+ * @file AsyncGovernor.h
+ *
+ * @brief Provides an overload governor that stretches the intervals of
+ * non-critical timers while the CPU is busy.
+ *
+ * @author boolscope
+ */
+#ifndef _ASYNC_GOVERNOR_H
+#define _ASYNC_GOVERNOR_H
+
+#include <stdint.h>
+
+#include "AsyncDelay.h"
+#include "AsyncScheduler.h"
+
+/**
+ * @class AsyncGovernor
+ * @brief Degrades low-priority timers gracefully under load.
+ *
+ * Every timer of the scheduler can be given a criticality class: 0 is
+ * critical and never touched (the default), 1 to MAX_CLASS are
+ * increasingly expendable. Once per window the governor measures the
+ * utilization, i.e. the callback time collected by the scheduler plus any
+ * busy time reported with addBusyTime(), relative to the measured window
+ * length.
+ *
+ * Above the high watermark the stretch level goes up by one per window,
+ * below the low watermark it goes down by one. At level L a timer of class
+ * c runs with its base interval multiplied by 1 + L * c / 4, but never more
+ * than its declared maximum stretch. Intervals are retimed with
+ * RETIME_KEEP_ELAPSED, so a stretched timer keeps its phase, and the base
+ * intervals are restored exactly when the level drops back to 0.
+ *
+ * The base interval of a timer is captured by setClass(); change intervals
+ * of managed timers through setClass() again, not through setInterval().
+ *
+ * @code
+ * AsyncScheduler scheduler;
+ * AsyncGovernor governor(scheduler, 1000, 80, 50);
+ *
+ * void setup() {
+ *   scheduler.add(control);
+ *   scheduler.add(display);
+ *   scheduler.add(logger);
+ *   governor.setClass(display, 1, 2);  // at most twice as slow
+ *   governor.setClass(logger, 3, 8);   // at most eight times as slow
+ * }
+ *
+ * void loop() {
+ *   scheduler.poll();
+ *   governor.update();
+ * }
+ * @endcode
+ */
+class AsyncGovernor {
+private:
+    /** @brief The scheduler whose timers are governed. */
+    AsyncScheduler &scheduler;
+
+    /** @brief The criticality class of each slot, 0 = critical. */
+    uint8_t classes[AsyncScheduler::CAPACITY] = {};
+
+    /** @brief The maximum stretch factor of each slot. */
+    uint8_t limits[AsyncScheduler::CAPACITY] = {};
+
+    /** @brief The unstretched interval of each managed slot. */
+    unsigned long bases[AsyncScheduler::CAPACITY] = {};
+
+    /** @brief The callback time of each slot at the start of the window. */
+    unsigned long callbackTimes[AsyncScheduler::CAPACITY] = {};
+
+    /** @brief The scheduler generation each slot's state belongs to. */
+    uint8_t generations[AsyncScheduler::CAPACITY] = {};
+
+    /** @brief The scheduler statistics generation of `callbackTimes`. */
+    uint8_t statsGeneration = 0;
+
+    /** @brief Busy time reported during the window, in microseconds. */
+    unsigned long busyTime = 0;
+
+    /** @brief Measures the window. */
+    AsyncDelay window;
+
+    /** @brief The utilization above which the level goes up, in percent. */
+    uint8_t high;
+
+    /** @brief The utilization below which the level goes down, in percent. */
+    uint8_t low;
+
+    /** @brief The current stretch level. */
+    uint8_t level = 0;
+
+    /** @brief The utilization of the last window, in percent. */
+    uint8_t utilization = 0;
+
+    /** @brief Drops the state of a slot that add() has reused. */
+    void sync(unsigned char index);
+
+    /** @brief Retimes all managed timers to the current level. */
+    void apply(unsigned long now);
+
+public:
+    // The least critical class.
+    static const uint8_t MAX_CLASS = 4;
+
+    // The highest stretch level.
+    static const uint8_t MAX_LEVEL = 16;
+
+    /** @brief Constructs a new AsyncGovernor object.
+     *
+     * @param[in] scheduler The scheduler whose timers are governed.
+     * @param[in] window The measurement window in milliseconds. Defaults to
+     * 1000.
+     * @param[in] high The high watermark in percent. Defaults to 80.
+     * @param[in] low The low watermark in percent. Defaults to 50.
+     */
+    AsyncGovernor(AsyncScheduler &scheduler, unsigned long window = 1000,
+                  uint8_t high = 80, uint8_t low = 50);
+
+    /** @brief Sets the criticality class of a registered timer.
+     *
+     * Captures the current interval of the timer as its base interval.
+     * Class 0 restores the base interval and releases the timer.
+     *
+     * @param[in] timer The timer, registered with the scheduler.
+     * @param[in] cls The class, 0 (critical) to MAX_CLASS.
+     * @param[in] maxStretch The largest factor the interval may be
+     * multiplied by. Defaults to 4.
+     *
+     * @retval true if the class was set.
+     * @retval false if the timer is not registered.
+     */
+    bool setClass(AsyncDelay &timer, uint8_t cls, uint8_t maxStretch = 4);
+
+    /** @brief Adds busy time that the scheduler does not see.
+     *
+     * @param[in] time The busy time in microseconds.
+     *
+     * @return void
+     */
+    void addBusyTime(unsigned long time);
+
+    /** @brief Measures the utilization once per window and adjusts the
+     * level.
+     *
+     * @retval true if the level has changed.
+     * @retval false otherwise.
+     */
+    bool update();
+
+    /** @brief Measures the utilization at the given time.
+     *
+     * @param[in] now The current time in milliseconds.
+     *
+     * @retval true if the level has changed.
+     * @retval false otherwise.
+     */
+    bool update(unsigned long now);
+
+    /** @brief Drops the level to 0 and restores all base intervals.
+     *
+     * @return void
+     */
+    void restore();
+
+    /** @brief Retrieves the current stretch level.
+     *
+     * @return The level, 0 = no timer is stretched.
+     */
+    uint8_t getLevel();
+
+    /** @brief Retrieves the utilization of the last window.
+     *
+     * @return The utilization in percent, at most 100.
+     */
+    uint8_t getUtilization();
+};
+
+#endif  // _ASYNC_GOVERNOR_H
@@ -0,0 +1,154 @@
+#include "AsyncIdleRunner.h"
+
+#include <Arduino.h>
+
+#include "AsyncClock.h"
+
+/**
+ * @brief Constructs a new AsyncIdleRunner object.
+ *
+ * @param[in] scheduler The scheduler whose timers must not be delayed.
+ * @param[in] margin The safety margin in microseconds.
+ */
+AsyncIdleRunner::AsyncIdleRunner(AsyncScheduler &scheduler,
+                                 unsigned long margin)
+    : scheduler(scheduler), margin(margin) {}
+
+/**
+ * @brief Registers a job in the first free slot.
+ *
+ * @param[in] fn The function running one slice of the job.
+ * @param[in] estimate The initial estimate of a slice in microseconds.
+ *
+ * @return `true` if the job was registered, `false` if the runner is full.
+ */
+bool AsyncIdleRunner::add(AsyncIdleJob fn, unsigned long estimate) {
+    for (unsigned char i = 0; i < CAPACITY; i++) {
+        if (this->jobs[i].fn == nullptr) {
+            this->jobs[i].fn = fn;
+            this->jobs[i].estimate = estimate;
+            this->jobs[i].measured = estimate;
+            this->jobs[i].slices = 0;
+            this->jobs[i].skips = 0;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Removes a job.
+ *
+ * @param[in] fn The function given to add().
+ *
+ * @return `true` if the job has been removed, `false` if it was not
+ * registered.
+ */
+bool AsyncIdleRunner::remove(AsyncIdleJob fn) {
+    for (unsigned char i = 0; i < CAPACITY; i++) {
+        if (this->jobs[i].fn == fn) {
+            this->jobs[i].fn = nullptr;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Sets the safety margin.
+ *
+ * @param[in] margin The margin in microseconds.
+ */
+void AsyncIdleRunner::setMargin(unsigned long margin) {
+    this->margin = margin;
+}
+
+/**
+ * @brief Retrieves the learned slice cost of a job.
+ *
+ * @param[in] index The job slot, must be less than CAPACITY.
+ *
+ * @return The estimate in microseconds.
+ */
+unsigned long AsyncIdleRunner::getEstimate(unsigned char index) {
+    return this->jobs[index].estimate;
+}
+
+/**
+ * @brief Retrieves the number of slices a job has run.
+ *
+ * @param[in] index The job slot, must be less than CAPACITY.
+ *
+ * @return The number of slices that did work.
+ */
+unsigned long AsyncIdleRunner::getSlices(unsigned char index) {
+    return this->jobs[index].slices;
+}
+
+/**
+ * @brief Runs the slices that fit into the current idle gap.
+ *
+ * The gap is read from the scheduler once; the measured duration of every
+ * slice is subtracted from it before the next job is considered.
+ *
+ * @return The number of slices run.
+ */
+unsigned char AsyncIdleRunner::run() {
+    unsigned long idle = this->scheduler.getIdleTime(AsyncClock::read());
+    if (idle <= 1) {
+        return 0;
+    }
+
+    // One millisecond is kept as reserve for the clock resolution.
+    if (idle > MAX_GAP) {
+        idle = MAX_GAP;
+    }
+
+    unsigned long budget = (idle - 1) * 1000UL;
+    unsigned char ran = 0;
+
+    for (unsigned char n = 0; n < CAPACITY; n++) {
+        Job &job = this->jobs[this->cursor];
+        this->cursor = (this->cursor + 1) % CAPACITY;
+        if (job.fn == nullptr) {
+            continue;
+        }
+
+        if (job.estimate + this->margin > budget) {
+            // The decay only discards what is left of an outlier, the
+            // cost last measured is kept.
+            if (++job.skips == SKIP_LIMIT) {
+                job.skips = 0;
+                job.estimate -= (job.estimate - job.measured) >> 3;
+            }
+            continue;
+        }
+
+        job.skips = 0;
+
+        unsigned long start = micros();
+        bool worked = job.fn();
+        unsigned long elapsed = micros() - start;
+
+        budget = elapsed < budget ? budget - elapsed : 0;
+        if (!worked) {
+            continue;
+        }
+
+        job.measured = elapsed;
+
+        // Overruns are learned at once, faster slices only slowly.
+        if (elapsed > job.estimate) {
+            job.estimate = elapsed;
+        } else {
+            job.estimate -= (job.estimate - elapsed) >> 3;
+        }
+
+        job.slices++;
+        ran++;
+    }
+
+    return ran;
+}
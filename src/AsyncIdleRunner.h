@@ -0,0 +1,168 @@
+/**
+ * @file AsyncIdleRunner.h
+ *
+ * @brief Provides background jobs that run only while no timer is due soon.
+ *
+ * @author boolscope
+ */
+#ifndef _ASYNC_IDLE_RUNNER_H
+#define _ASYNC_IDLE_RUNNER_H
+
+#include <stdint.h>
+
+#include "AsyncScheduler.h"
+
+/**
+ * @brief The maximum number of jobs an idle runner can hold.
+ *
+ * Define it before including this header to change it.
+ */
+#ifndef ASYNC_IDLE_JOBS
+#define ASYNC_IDLE_JOBS 4
+#endif
+
+/**
+ * @brief Runs one slice of a background job.
+ *
+ * @return `true` if the slice did some work, `false` if the job had nothing
+ * to do (the duration of such calls is not learned).
+ */
+typedef bool (*AsyncIdleJob)();
+
+/**
+ * @class AsyncIdleRunner
+ * @brief Runs slices of low-priority jobs in the gaps between timer
+ * deadlines.
+ *
+ * Every job declares the estimated cost of one slice. run() asks the
+ * scheduler how long it is until the earliest timer is due and runs a
+ * slice only if that gap is larger than the estimate plus a safety margin,
+ * so housekeeping never delays a foreground timer that it knows about.
+ *
+ * The estimate is learned from the measured slice durations: a slice that
+ * takes longer than estimated raises the estimate to the measured value
+ * immediately, shorter slices lower it slowly (an exponentially weighted
+ * moving average with weight 1/8). A job that has been skipped SKIP_LIMIT
+ * times in a row moves its estimate 1/8 of the way down to the duration of
+ * its last measured slice (the declared estimate before the first one), so
+ * an outlier cannot starve it forever, yet it is never started in a gap its
+ * last measured cost does not fit. Jobs are visited round-robin, each at
+ * most once per run().
+ *
+ * The scheduler resolves time in milliseconds, so one millisecond of the
+ * gap is always kept as reserve.
+ *
+ * @code
+ * AsyncScheduler scheduler;
+ * AsyncIdleRunner idle(scheduler, 200);
+ *
+ * bool scrub() {
+ *   return flash.scrubNextPage();
+ * }
+ *
+ * void setup() {
+ *   idle.add(scrub, 1500);
+ * }
+ *
+ * void loop() {
+ *   scheduler.poll();
+ *   idle.run();
+ * }
+ * @endcode
+ */
+class AsyncIdleRunner {
+private:
+    /**
+     * @struct Job
+     * @brief A registered job and its learned slice cost.
+     */
+    struct Job {
+        AsyncIdleJob fn = nullptr;
+        unsigned long estimate = 0;
+        unsigned long measured = 0;
+        unsigned long slices = 0;
+        uint8_t skips = 0;
+    };
+
+    /** @brief The scheduler whose deadlines gate the jobs. */
+    AsyncScheduler &scheduler;
+
+    /** @brief The registered jobs, a nullptr function marks a free slot. */
+    Job jobs[ASYNC_IDLE_JOBS];
+
+    /** @brief The safety margin in microseconds. */
+    unsigned long margin;
+
+    /** @brief The job visited first by the next run(). */
+    unsigned char cursor = 0;
+
+public:
+    // The number of job slots.
+    static const unsigned char CAPACITY = ASYNC_IDLE_JOBS;
+
+    // Consecutive skips after which a job's estimate is lowered towards its
+    // last measured slice duration.
+    static const uint8_t SKIP_LIMIT = 255;
+
+    // The longest gap considered, in milliseconds; keeps microsecond
+    // arithmetic within 32 bits.
+    static const unsigned long MAX_GAP = 60000;
+
+    /** @brief Constructs a new AsyncIdleRunner object.
+     *
+     * @param[in] scheduler The scheduler whose timers must not be delayed.
+     * @param[in] margin The safety margin in microseconds. Defaults to 100.
+     */
+    AsyncIdleRunner(AsyncScheduler &scheduler, unsigned long margin = 100);
+
+    /** @brief Registers a job.
+     *
+     * @param[in] fn The function running one slice of the job.
+     * @param[in] estimate The initial estimate of a slice in microseconds.
+     *
+     * @retval true if the job was registered.
+     * @retval false if there is no free slot.
+     */
+    bool add(AsyncIdleJob fn, unsigned long estimate);
+
+    /** @brief Removes a job.
+     *
+     * @param[in] fn The function given to add().
+     *
+     * @retval true if the job was registered.
+     * @retval false otherwise.
+     */
+    bool remove(AsyncIdleJob fn);
+
+    /** @brief Sets the safety margin.
+     *
+     * @param[in] margin The margin in microseconds.
+     *
+     * @return void
+     */
+    void setMargin(unsigned long margin);
+
+    /** @brief Retrieves the learned slice cost of a job.
+     *
+     * @param[in] index The job slot, must be less than CAPACITY.
+     *
+     * @return The estimate in microseconds.
+     */
+    unsigned long getEstimate(unsigned char index);
+
+    /** @brief Retrieves the number of slices a job has run.
+     *
+     * @param[in] index The job slot, must be less than CAPACITY.
+     *
+     * @return The number of slices that did work.
+     */
+    unsigned long getSlices(unsigned char index);
+
+    /** @brief Runs the slices that fit into the current idle gap.
+     *
+     * @return The number of slices run.
+     */
+    unsigned char run();
+};
+
+#endif  // _ASYNC_IDLE_RUNNER_H
@@ -0,0 +1,73 @@
+/**
+ * @file AsyncName.h
+ *
+ * @brief Provides compile-time hashed timer names.
+ *
+ * @author boolscope
+ */
+#ifndef _ASYNC_NAME_H
+#define _ASYNC_NAME_H
+
+#include <stdint.h>
+
+/**
+ * @brief Calculates the 32-bit FNV-1a hash of a string at compile time.
+ *
+ * @param[in] s The zero-terminated string.
+ * @param[in] hash The running hash, leave at the default.
+ *
+ * @return The FNV-1a hash.
+ */
+constexpr uint32_t asyncFnv1a(const char *s, uint32_t hash = 2166136261UL) {
+    return *s == '\0' ? hash
+                      : asyncFnv1a(s + 1, (hash ^ (uint8_t)*s) * 16777619UL);
+}
+
+/**
+ * @brief Folds a 32-bit hash into 16 bits.
+ *
+ * @param[in] hash The 32-bit hash.
+ *
+ * @return The upper and lower halves combined with XOR.
+ */
+constexpr uint16_t asyncFold16(uint32_t hash) {
+    return (uint16_t)((hash >> 16) ^ (hash & 0xFFFF));
+}
+
+/**
+ * @brief Calculates the 16-bit id of a timer name.
+ *
+ * Use the ASYNC_NAME() macro to make sure the hash is calculated by the
+ * compiler and the string never reaches the firmware image.
+ *
+ * @param[in] name The timer name.
+ *
+ * @return The 16-bit name id.
+ */
+constexpr uint16_t asyncNameHash(const char *name) {
+    return asyncFold16(asyncFnv1a(name));
+}
+
+/**
+ * @brief Holds a name id as a compile-time constant.
+ */
+template <uint16_t Id>
+struct AsyncNameId {
+    static const uint16_t value = Id;
+};
+
+/**
+ * @brief Turns a string literal into a 16-bit name id at compile time.
+ *
+ * The id is carried by the scheduler, the console and the telemetry frames.
+ * `make names` scans the sources for this macro and writes the host-side
+ * map from ids back to names, which the telemetry decoder uses to restore
+ * the names.
+ *
+ * @code
+ * scheduler.add(sensorDelay, ASYNC_NAME("sensor"));
+ * @endcode
+ */
+#define ASYNC_NAME(name) (AsyncNameId<asyncNameHash(name)>::value)
+
+#endif  // _ASYNC_NAME_H
@@ -0,0 +1,176 @@
+#include "AsyncPlcTimer.h"
+
+#include <Arduino.h>
+
+#include "AsyncClock.h"
+
+#include "AsyncDelay.h"
+
+/**
+ * @brief Constructs a new AsyncPlcTimer block.
+ *
+ * @param[in] type The behaviour of the block.
+ * @param[in] preset The preset time in milliseconds.
+ */
+AsyncPlcTimer::AsyncPlcTimer(Type type, unsigned long preset) : type(type) {
+    this->setPreset(preset);
+}
+
+/**
+ * @brief Sets the preset time, clamped to AsyncDelay::MAX_INTERVAL.
+ *
+ * @param[in] preset The preset time in milliseconds.
+ */
+void AsyncPlcTimer::setPreset(unsigned long preset) {
+    this->preset =
+        preset > AsyncDelay::MAX_INTERVAL ? AsyncDelay::MAX_INTERVAL : preset;
+}
+
+/**
+ * @brief Retrieves the preset time.
+ *
+ * @return The preset time in milliseconds.
+ */
+unsigned long AsyncPlcTimer::getPreset() {
+    return this->preset;
+}
+
+/**
+ * @brief Sets the input bit.
+ *
+ * Only the bit is stored; edges are detected by the next update().
+ *
+ * @param[in] in The new input value.
+ */
+void AsyncPlcTimer::setInput(bool in) {
+    if (in) {
+        this->flags |= FLAG_IN;
+    } else {
+        this->flags &= ~FLAG_IN;
+    }
+}
+
+/**
+ * @brief Retrieves the input bit.
+ *
+ * @return The input value.
+ */
+bool AsyncPlcTimer::getInput() {
+    return this->flags & FLAG_IN;
+}
+
+/**
+ * @brief Retrieves the output bit computed by the last update.
+ *
+ * @return The output value.
+ */
+bool AsyncPlcTimer::getOutput() {
+    return this->flags & FLAG_Q;
+}
+
+/**
+ * @brief Checks if a delay or pulse period is running.
+ *
+ * @return `true` while the block is timing, `false` otherwise.
+ */
+bool AsyncPlcTimer::isRunning() {
+    return this->flags & FLAG_RUNNING;
+}
+
+/**
+ * @brief Calculates the elapsed time of the running period.
+ *
+ * Unsigned subtraction keeps the result correct across the millis()
+ * rollover.
+ *
+ * @param[in] now The current time in milliseconds.
+ *
+ * @return The elapsed time, at most the preset, or 0 if not running.
+ */
+unsigned long AsyncPlcTimer::getElapsed(unsigned long now) {
+    if (!(this->flags & FLAG_RUNNING)) {
+        return 0;
+    }
+
+    unsigned long elapsed = now - this->start;
+    return elapsed > this->preset ? this->preset : elapsed;
+}
+
+/**
+ * @brief Evaluates the block at the given time.
+ *
+ * Rising and falling edges are detected against the input seen by the
+ * previous update, so the block reacts to pulses that are at least one scan
+ * long.
+ *
+ * @param[in] now The current time in milliseconds.
+ */
+void AsyncPlcTimer::update(unsigned long now) {
+    uint8_t f = this->flags;
+    bool in = f & FLAG_IN;
+    bool rising = in && !(f & FLAG_PREV_IN);
+    bool falling = !in && (f & FLAG_PREV_IN);
+
+    switch (this->type) {
+        case TON:
+            if (!in) {
+                f &= ~(FLAG_Q | FLAG_RUNNING);
+            } else if (rising) {
+                this->start = now;
+                f = (f & ~FLAG_Q) | FLAG_RUNNING;
+            }
+            break;
+
+        case TOF:
+            if (in) {
+                f = (f & ~FLAG_RUNNING) | FLAG_Q;
+            } else if (falling) {
+                this->start = now;
+                f |= FLAG_RUNNING;
+            }
+            break;
+
+        case TP:
+            if (rising && !(f & FLAG_RUNNING)) {
+                this->start = now;
+                f |= FLAG_RUNNING | FLAG_Q;
+            }
+            break;
+    }
+
+    // The period has run out: TON switches on, TOF and TP switch off.
+    if ((f & FLAG_RUNNING) && now - this->start >= this->preset) {
+        f &= ~FLAG_RUNNING;
+        if (this->type == TON) {
+            f |= FLAG_Q;
+        } else {
+            f &= ~FLAG_Q;
+        }
+    }
+
+    this->flags = in ? (f | FLAG_PREV_IN) : (f & ~FLAG_PREV_IN);
+}
+
+/**
+ * @brief Evaluates an array of blocks against one clock read.
+ *
+ * @param[in,out] timers The blocks to evaluate.
+ * @param[in] count The number of blocks.
+ */
+void AsyncPlcTimer::scan(AsyncPlcTimer *timers, size_t count) {
+    scan(timers, count, AsyncClock::read());
+}
+
+/**
+ * @brief Evaluates an array of blocks at the given time.
+ *
+ * @param[in,out] timers The blocks to evaluate.
+ * @param[in] count The number of blocks.
+ * @param[in] now The current time in milliseconds.
+ */
+void AsyncPlcTimer::scan(AsyncPlcTimer *timers, size_t count,
+                         unsigned long now) {
+    for (size_t i = 0; i < count; i++) {
+        timers[i].update(now);
+    }
+}
@@ -0,0 +1,159 @@
+/**
+ * @file AsyncPlcTimer.h
+ *
+ * @brief Provides compact IEC 61131-3 style timer blocks (TON, TOF, TP)
+ * that are evaluated in batches.
+ *
+ * @author boolscope
+ */
+#ifndef _ASYNC_PLC_TIMER_H
+#define _ASYNC_PLC_TIMER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @class AsyncPlcTimer
+ * @brief A PLC timer block with an input bit and an output bit.
+ *
+ * - TON (on-delay): the output becomes true once the input has been true
+ *   for the preset time, and false as soon as the input is false.
+ * - TOF (off-delay): the output follows a true input immediately and stays
+ *   true for the preset time after the input became false.
+ * - TP (pulse): a rising edge of the input starts a pulse of exactly the
+ *   preset time; edges during the pulse are ignored.
+ *
+ * A block takes 10 bytes on AVR (start time, preset and two flag bytes), so
+ * hundreds of them fit into an array. Inputs are written with setInput()
+ * while the I/O image is read, then the whole array is evaluated with one
+ * call to scan() that reads the clock once. The cost of a scan is linear
+ * in the number of blocks and does not depend on their state.
+ *
+ * @code
+ * AsyncPlcTimer debounce[64];
+ *
+ * void setup() {
+ *   for (auto &t : debounce) {
+ *     t = AsyncPlcTimer(AsyncPlcTimer::TON, 50);
+ *   }
+ * }
+ *
+ * void loop() {
+ *   for (uint8_t i = 0; i < 64; i++) {
+ *     debounce[i].setInput(readInput(i));
+ *   }
+ *   AsyncPlcTimer::scan(debounce, 64);
+ *   for (uint8_t i = 0; i < 64; i++) {
+ *     writeOutput(i, debounce[i].getOutput());
+ *   }
+ * }
+ * @endcode
+ */
+class AsyncPlcTimer {
+public:
+    /** @brief The behaviour of a timer block. */
+    enum Type : uint8_t {
+        TON,  ///< On-delay timer.
+        TOF,  ///< Off-delay timer.
+        TP    ///< Pulse timer.
+    };
+
+private:
+    // Flag bits.
+    static const uint8_t FLAG_IN = 0x01;
+    static const uint8_t FLAG_Q = 0x02;
+    static const uint8_t FLAG_PREV_IN = 0x04;
+    static const uint8_t FLAG_RUNNING = 0x08;
+
+    /** @brief The time (in milliseconds) the current timing period started.
+     */
+    unsigned long start = 0;
+
+    /** @brief The preset time (PT) in milliseconds. */
+    unsigned long preset = 0;
+
+    /** @brief The behaviour of the block. */
+    Type type = TON;
+
+    /** @brief Input, output, previous input and running bits. */
+    uint8_t flags = 0;
+
+public:
+    /** @brief Constructs a new AsyncPlcTimer block.
+     *
+     * @param[in] type The behaviour of the block. Defaults to TON.
+     * @param[in] preset The preset time in milliseconds. Defaults to 0.
+     */
+    AsyncPlcTimer(Type type = TON, unsigned long preset = 0);
+
+    /** @brief Sets the preset time.
+     *
+     * A period that is already running uses the new preset from the next
+     * scan on. Values above AsyncDelay::MAX_INTERVAL are clamped.
+     *
+     * @param[in] preset The preset time in milliseconds.
+     */
+    void setPreset(unsigned long preset);
+
+    /** @brief Retrieves the preset time.
+     *
+     * @return The preset time in milliseconds.
+     */
+    unsigned long getPreset();
+
+    /** @brief Sets the input bit, evaluated by the next scan.
+     *
+     * @param[in] in The new input value.
+     */
+    void setInput(bool in);
+
+    /** @brief Retrieves the input bit.
+     *
+     * @return The input value set by setInput().
+     */
+    bool getInput();
+
+    /** @brief Retrieves the output bit computed by the last scan.
+     *
+     * @return The output value.
+     */
+    bool getOutput();
+
+    /** @brief Checks if the block is timing.
+     *
+     * @return True while a delay or pulse period is running.
+     */
+    bool isRunning();
+
+    /** @brief Calculates the elapsed time of the running period (ET).
+     *
+     * @param[in] now The current time in milliseconds.
+     *
+     * @return The elapsed time, limited to the preset, or 0 if the block is
+     * not running.
+     */
+    unsigned long getElapsed(unsigned long now);
+
+    /** @brief Evaluates the block at the given time.
+     *
+     * @param[in] now The current time in milliseconds.
+     */
+    void update(unsigned long now);
+
+    /** @brief Evaluates an array of blocks against one clock read.
+     *
+     * @param[in,out] timers The blocks to evaluate.
+     * @param[in] count The number of blocks.
+     */
+    static void scan(AsyncPlcTimer *timers, size_t count);
+
+    /** @brief Evaluates an array of blocks at the given time.
+     *
+     * @param[in,out] timers The blocks to evaluate.
+     * @param[in] count The number of blocks.
+     * @param[in] now The current time in milliseconds.
+     */
+    static void scan(AsyncPlcTimer *timers, size_t count, unsigned long now);
+};
+
+#endif  // _ASYNC_PLC_TIMER_H
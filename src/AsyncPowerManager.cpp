@@ -0,0 +1,119 @@
+#include "AsyncPowerManager.h"
+
+#include <Arduino.h>
+
+#include "AsyncClock.h"
+
+/**
+ * @brief Constructs a new AsyncPowerManager object.
+ *
+ * @param[in] scheduler The scheduler whose deadlines limit the sleep.
+ * @param[in] modes The sleep modes, ordered from shallow to deep.
+ * @param[in] count The number of modes, clamped to ASYNC_SLEEP_MODES.
+ */
+AsyncPowerManager::AsyncPowerManager(AsyncScheduler &scheduler,
+                                     const AsyncSleepMode *modes,
+                                     uint8_t count)
+    : scheduler(scheduler),
+      modes(modes),
+      count(count > ASYNC_SLEEP_MODES ? ASYNC_SLEEP_MODES : count) {}
+
+/**
+ * @brief Selects the deepest mode that fits into an idle gap.
+ *
+ * A mode fits if the gap covers its break-even time and is longer than its
+ * wake latency.
+ *
+ * @param[in] gap The idle gap in microseconds.
+ *
+ * @return The mode index, or NONE.
+ */
+int AsyncPowerManager::select(unsigned long gap) {
+    for (int i = this->count - 1; i >= 0; i--) {
+        const AsyncSleepMode &mode = this->modes[i];
+        if (gap >= mode.breakEven && gap > mode.wakeLatency) {
+            return i;
+        }
+    }
+
+    return NONE;
+}
+
+/**
+ * @brief Calculates the usable idle gap at the given time.
+ *
+ * One millisecond of the scheduler's idle time is kept as reserve for the
+ * millisecond resolution of the timers.
+ *
+ * @param[in] now The current time in milliseconds.
+ *
+ * @return The gap in microseconds.
+ */
+unsigned long AsyncPowerManager::getGap(unsigned long now) {
+    unsigned long idle = this->scheduler.getIdleTime(now);
+    if (idle <= 1) {
+        return 0;
+    }
+
+    if (idle > MAX_GAP) {
+        idle = MAX_GAP;
+    }
+
+    return (idle - 1) * 1000UL;
+}
+
+/**
+ * @brief Sleeps until shortly before the next deadline.
+ *
+ * @return The index of the mode entered, or NONE.
+ */
+int AsyncPowerManager::sleep() {
+    return this->sleep(AsyncClock::read());
+}
+
+/**
+ * @brief Sleeps until shortly before the next deadline, computed at the
+ * given time.
+ *
+ * The wakeup is armed the mode's wake latency before the end of the gap.
+ *
+ * @param[in] now The current time in milliseconds.
+ *
+ * @return The index of the mode entered, or NONE.
+ */
+int AsyncPowerManager::sleep(unsigned long now) {
+    unsigned long gap = this->getGap(now);
+    int i = this->select(gap);
+    if (i == NONE) {
+        return NONE;
+    }
+
+    unsigned long duration = gap - this->modes[i].wakeLatency;
+    this->entries[i]++;
+    this->sleepTimes[i] += duration / 1000;
+    this->modes[i].enter(duration);
+
+    return i;
+}
+
+/**
+ * @brief Retrieves how often a mode was entered.
+ *
+ * @param[in] mode The mode index.
+ *
+ * @return The number of entries.
+ */
+unsigned long AsyncPowerManager::getEntries(uint8_t mode) {
+    return this->entries[mode];
+}
+
+/**
+ * @brief Retrieves the total requested sleep time of a mode.
+ *
+ * @param[in] mode The mode index.
+ *
+ * @return The time in milliseconds.
+ */
+unsigned long AsyncPowerManager::getSleepTime(uint8_t mode) {
+    return this->sleepTimes[mode];
+}
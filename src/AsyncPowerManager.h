@@ -0,0 +1,164 @@
+/**
+ * @file AsyncPowerManager.h
+ *
+ * @brief Provides sleep-depth selection from the distance to the next timer
+ * deadline.
+ *
+ * @author boolscope
+ */
+#ifndef _ASYNC_POWER_MANAGER_H
+#define _ASYNC_POWER_MANAGER_H
+
+#include <stdint.h>
+
+#include "AsyncScheduler.h"
+
+/**
+ * @brief The maximum number of sleep modes.
+ *
+ * Define it before including this header to change it.
+ */
+#ifndef ASYNC_SLEEP_MODES
+#define ASYNC_SLEEP_MODES 4
+#endif
+
+/**
+ * @struct AsyncSleepMode
+ * @brief Describes one sleep mode of the MCU.
+ */
+struct AsyncSleepMode {
+    /** @brief The time from the wakeup event until code runs again, in
+     * microseconds.
+     */
+    unsigned long wakeLatency;
+
+    /** @brief The shortest sleep that saves energy (entering and leaving
+     * the mode costs energy too), in microseconds.
+     */
+    unsigned long breakEven;
+
+    /** @brief Arms a wakeup source to fire after `duration` microseconds and
+     * enters the mode. Returns after the wakeup.
+     */
+    void (*enter)(unsigned long duration);
+};
+
+/**
+ * @class AsyncPowerManager
+ * @brief Sleeps as deep as the next scheduler deadline allows.
+ *
+ * The manager is given a table of sleep modes ordered from shallow to deep.
+ * sleep() asks the scheduler for the idle gap until the earliest timer is
+ * due and enters the deepest mode whose break-even time and wake latency
+ * both fit into the gap. The wakeup is armed `wakeLatency` before the
+ * deadline (pre-wake), so the CPU runs again in time for the timer to fire
+ * on schedule. If no mode fits, sleep() returns at once.
+ *
+ * The scheduler resolves time in milliseconds, so one millisecond of the
+ * gap is kept as reserve. Interrupts may end a sleep early; the next
+ * loop() iteration simply polls and sleeps again.
+ *
+ * On the host, hostSimulateClock() and an enter function that calls
+ * hostAdvanceClock() allow testing the policy against a simulated clock.
+ *
+ * @code
+ * void idleMode(unsigned long us) { set_sleep_mode(SLEEP_MODE_IDLE); ... }
+ * void powerDown(unsigned long us) { armWatchdog(us); ... }
+ *
+ * const AsyncSleepMode modes[] = {
+ *   {10, 50, idleMode},
+ *   {6000, 20000, powerDown},
+ * };
+ *
+ * AsyncPowerManager power(scheduler, modes, 2);
+ *
+ * void loop() {
+ *   scheduler.poll();
+ *   power.sleep();
+ * }
+ * @endcode
+ */
+class AsyncPowerManager {
+private:
+    /** @brief The scheduler whose deadlines limit the sleep. */
+    AsyncScheduler &scheduler;
+
+    /** @brief The sleep modes, ordered from shallow to deep. */
+    const AsyncSleepMode *modes;
+
+    /** @brief The number of sleep modes. */
+    uint8_t count;
+
+    /** @brief How often each mode was entered. */
+    unsigned long entries[ASYNC_SLEEP_MODES] = {};
+
+    /** @brief The requested sleep time of each mode in milliseconds. */
+    unsigned long sleepTimes[ASYNC_SLEEP_MODES] = {};
+
+public:
+    // Returned by select() and sleep() when no mode fits.
+    static const int NONE = -1;
+
+    // The longest gap considered, in milliseconds; keeps microsecond
+    // arithmetic within 32 bits.
+    static const unsigned long MAX_GAP = 60000;
+
+    /** @brief Constructs a new AsyncPowerManager object.
+     *
+     * @param[in] scheduler The scheduler whose deadlines limit the sleep.
+     * @param[in] modes The sleep modes, ordered from shallow to deep. The
+     * table is not copied.
+     * @param[in] count The number of modes, at most ASYNC_SLEEP_MODES.
+     */
+    AsyncPowerManager(AsyncScheduler &scheduler, const AsyncSleepMode *modes,
+                      uint8_t count);
+
+    /** @brief Selects the deepest mode that fits into an idle gap.
+     *
+     * @param[in] gap The idle gap in microseconds.
+     *
+     * @return The mode index, or NONE.
+     */
+    int select(unsigned long gap);
+
+    /** @brief Calculates the usable idle gap at the given time.
+     *
+     * @param[in] now The current time in milliseconds.
+     *
+     * @return The gap in microseconds.
+     */
+    unsigned long getGap(unsigned long now);
+
+    /** @brief Sleeps until shortly before the next deadline.
+     *
+     * @return The index of the mode entered, or NONE.
+     */
+    int sleep();
+
+    /** @brief Sleeps until shortly before the next deadline, computed at the
+     * given time.
+     *
+     * @param[in] now The current time in milliseconds.
+     *
+     * @return The index of the mode entered, or NONE.
+     */
+    int sleep(unsigned long now);
+
+    /** @brief Retrieves how often a mode was entered.
+     *
+     * @param[in] mode The mode index.
+     *
+     * @return The number of entries.
+     */
+    unsigned long getEntries(uint8_t mode);
+
+    /** @brief Retrieves the total requested sleep time of a mode.
+     *
+     * @param[in] mode The mode index.
+     *
+     * @return The time in milliseconds.
+     */
+    unsigned long getSleepTime(uint8_t mode);
+};
+
+#endif  // _ASYNC_POWER_MANAGER_H
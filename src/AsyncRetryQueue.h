@@ -0,0 +1,323 @@
+/**
+ * @file AsyncRetryQueue.h
+ *
+ * @brief Provides acknowledgement timeouts with bounded retries for
+ * in-flight messages.
+ *
+ * @author boolscope
+ */
+#ifndef _ASYNC_RETRY_QUEUE_H
+#define _ASYNC_RETRY_QUEUE_H
+
+#include <Arduino.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "AsyncClock.h"
+#include "AsyncDelay.h"
+#include "AsyncTimerWheel.h"
+
+/**
+ * @class AsyncRetryQueue
+ * @brief Tracks in-flight messages in a fixed pool with deadlines in a
+ * timing wheel.
+ *
+ * The application hands a message to push(), which copies it into the pool
+ * and returns its id; the stored copy, reached through get(), is the one
+ * to fill in the id and send. When the acknowledgement arrives, ack()
+ * removes the message in O(1): the id encodes the pool slot plus a
+ * generation counter, so no search is needed and stale or duplicate
+ * acknowledgements are rejected.
+ *
+ * poll() handles the messages whose timeout has passed, at most `budget`
+ * per call. A message is retried (the retry callback resends it) until
+ * `retries` retries have been made, the timeout doubling each time up to
+ * `maxTimeout`; after that the failure callback is invoked and the slot is
+ * released. No per-message AsyncDelay exists and nothing scans the pool, so
+ * thousands of messages can be in flight.
+ *
+ * @code
+ * AsyncRetryQueue<Packet, 64> pending(500, 3);
+ *
+ * void resend(uint32_t id, Packet &p) { radio.send(p); }
+ * void giveUp(uint32_t id, Packet &p) { log("lost", id); }
+ *
+ * void setup() {
+ *   pending.setRetryCallback(resend);
+ *   pending.setFailCallback(giveUp);
+ * }
+ *
+ * void send(const Packet &p) {
+ *   uint32_t id = pending.push(p);
+ *   Packet *stored = pending.get(id);
+ *   if (stored != nullptr) {
+ *     stored->id = id;  // resend() sends this copy
+ *     radio.send(*stored);
+ *   }
+ * }
+ *
+ * void loop() {
+ *   if (radio.ackReceived()) {
+ *     pending.ack(radio.ackId());
+ *   }
+ *   pending.poll(8);
+ * }
+ * @endcode
+ *
+ * @tparam T The message type, stored by value.
+ * @tparam Capacity The maximum number of in-flight messages (at most 65535).
+ * @tparam Slots The number of timing-wheel buckets.
+ */
+template <typename T, size_t Capacity, size_t Slots = 64>
+class AsyncRetryQueue {
+public:
+    /** @brief Called with the id and the message on retries and failure. */
+    typedef void (*MessageFunction)(uint32_t id, T &message);
+
+private:
+    typedef AsyncTimerWheel<Capacity, Slots> Wheel;
+    typedef typename Wheel::Index Index;
+
+    /** @brief The stored messages. */
+    T messages[Capacity];
+
+    /** @brief The current timeout of each message in milliseconds. */
+    unsigned long timeouts[Capacity];
+
+    /** @brief The generation of each slot, part of the message id. */
+    uint16_t generations[Capacity];
+
+    /** @brief The number of retries made for each message. */
+    uint8_t attempts[Capacity];
+
+    /** @brief A stack of unused slots. */
+    Index freeList[Capacity];
+
+    /** @brief The number of unused slots. */
+    size_t freeCount = Capacity;
+
+    /** @brief The deadlines of the in-flight messages. */
+    Wheel wheel;
+
+    /** @brief The timeout of the first attempt in milliseconds. */
+    unsigned long timeout;
+
+    /** @brief The upper bound of the backoff in milliseconds. */
+    unsigned long maxTimeout;
+
+    /** @brief The number of retries before giving up. */
+    uint8_t retries;
+
+    /** @brief Resends a message, may be nullptr. */
+    MessageFunction retryFunction = nullptr;
+
+    /** @brief Reports a message that ran out of retries, may be nullptr. */
+    MessageFunction failFunction = nullptr;
+
+    /** @brief Builds the id of a slot. */
+    uint32_t idOf(Index slot) {
+        return ((uint32_t)this->generations[slot] << 16) | (uint32_t)slot;
+    }
+
+    /** @brief Resolves an id to an in-flight slot, or Wheel::NONE. */
+    Index slotOf(uint32_t id) {
+        Index slot = id & 0xFFFF;
+        if (slot >= Capacity || !this->wheel.isScheduled(slot) ||
+            this->generations[slot] != (uint16_t)(id >> 16)) {
+            return Wheel::NONE;
+        }
+
+        return slot;
+    }
+
+    /** @brief Returns a slot to the free list. */
+    void release(Index slot) {
+        this->wheel.cancel(slot);
+        this->freeList[this->freeCount++] = slot;
+    }
+
+    /** @brief Clamps a timeout like AsyncDelay clamps intervals. */
+    static unsigned long clamp(unsigned long value) {
+        if (value == 0) {
+            return 1;
+        }
+
+        return value > AsyncDelay::MAX_INTERVAL ? AsyncDelay::MAX_INTERVAL
+                                                : value;
+    }
+
+public:
+    // The maximum number of in-flight messages.
+    static const size_t CAPACITY = Capacity;
+
+    // Never returned by push() for a stored message.
+    static const uint32_t INVALID_ID = 0;
+
+    /** @brief Constructs a new AsyncRetryQueue object.
+     *
+     * @param[in] timeout The acknowledgement timeout of the first attempt in
+     * milliseconds.
+     * @param[in] retries The number of retries before the message fails.
+     * @param[in] maxTimeout The upper bound of the exponential backoff in
+     * milliseconds. Defaults to AsyncDelay::MAX_INTERVAL.
+     * @param[in] resolution The timeout resolution in milliseconds.
+     * Defaults to 1.
+     */
+    AsyncRetryQueue(unsigned long timeout, uint8_t retries,
+                    unsigned long maxTimeout = AsyncDelay::MAX_INTERVAL,
+                    unsigned long resolution = 1)
+        : wheel(resolution),
+          timeout(clamp(timeout)),
+          maxTimeout(clamp(maxTimeout)),
+          retries(retries) {
+        static_assert(Capacity <= 0xFFFF, "Capacity must fit into 16 bits");
+        for (size_t i = 0; i < Capacity; i++) {
+            this->freeList[i] = Capacity - 1 - i;
+            this->generations[i] = 0;
+        }
+    }
+
+    /** @brief Sets the function that resends a message.
+     *
+     * @param[in] fn The function, or nullptr.
+     */
+    void setRetryCallback(MessageFunction fn) {
+        this->retryFunction = fn;
+    }
+
+    /** @brief Sets the function called when a message runs out of retries.
+     *
+     * @param[in] fn The function, or nullptr.
+     */
+    void setFailCallback(MessageFunction fn) {
+        this->failFunction = fn;
+    }
+
+    /** @brief Returns the number of in-flight messages.
+     *
+     * @return The number of in-flight messages.
+     */
+    size_t size() {
+        return Capacity - this->freeCount;
+    }
+
+    /** @brief Starts tracking a message that is about to be sent.
+     *
+     * @param[in] message The message, copied into the pool.
+     * @param[in] now The current time in milliseconds.
+     *
+     * @return The message id, or INVALID_ID if the pool is full.
+     */
+    uint32_t push(const T &message, unsigned long now) {
+        if (this->freeCount == 0) {
+            return INVALID_ID;
+        }
+
+        Index slot = this->freeList[--this->freeCount];
+
+        // Generation 0 is skipped so that an id is never INVALID_ID.
+        if (++this->generations[slot] == 0) {
+            this->generations[slot] = 1;
+        }
+
+        this->messages[slot] = message;
+        this->timeouts[slot] = this->timeout;
+        this->attempts[slot] = 0;
+        this->wheel.schedule(slot, now + this->timeout);
+
+        return this->idOf(slot);
+    }
+
+    /** @brief Starts tracking a message that is about to be sent.
+     *
+     * @param[in] message The message, copied into the pool.
+     *
+     * @return The message id, or INVALID_ID if the pool is full.
+     */
+    uint32_t push(const T &message) {
+        return this->push(message, AsyncClock::read());
+    }
+
+    /** @brief Acknowledges a message and stops tracking it.
+     *
+     * @param[in] id The message id returned by push().
+     *
+     * @retval true if the message was in flight.
+     * @retval false for unknown, stale or duplicate ids.
+     */
+    bool ack(uint32_t id) {
+        Index slot = this->slotOf(id);
+        if (slot == Wheel::NONE) {
+            return false;
+        }
+
+        this->release(slot);
+        return true;
+    }
+
+    /** @brief Retrieves an in-flight message.
+     *
+     * @param[in] id The message id returned by push().
+     *
+     * @return The message, or nullptr if it is not in flight.
+     */
+    T *get(uint32_t id) {
+        Index slot = this->slotOf(id);
+        return slot == Wheel::NONE ? nullptr : &this->messages[slot];
+    }
+
+    /** @brief Retries or fails up to `budget` timed-out messages.
+     *
+     * @param[in] budget The maximum number of messages to handle.
+     * @param[in] now The current time in milliseconds.
+     *
+     * @return The number of messages handled.
+     */
+    size_t poll(size_t budget, unsigned long now) {
+        size_t n = 0;
+        for (; n < budget; n++) {
+            Index slot = this->wheel.pop(now);
+            if (slot == Wheel::NONE) {
+                break;
+            }
+
+            uint32_t id = this->idOf(slot);
+            if (this->attempts[slot] >= this->retries) {
+                // The slot is released after the callback, so a push() from
+                // the callback cannot overwrite the message it reads.
+                if (this->failFunction != nullptr) {
+                    this->failFunction(id, this->messages[slot]);
+                }
+
+                this->freeList[this->freeCount++] = slot;
+                continue;
+            }
+
+            this->attempts[slot]++;
+            unsigned long next = this->timeouts[slot] * 2;
+            if (next > this->maxTimeout || next < this->timeouts[slot]) {
+                next = this->maxTimeout;
+            }
+
+            this->timeouts[slot] = next;
+            this->wheel.schedule(slot, now + next);
+            if (this->retryFunction != nullptr) {
+                this->retryFunction(id, this->messages[slot]);
+            }
+        }
+
+        return n;
+    }
+
+    /** @brief Retries or fails up to `budget` timed-out messages.
+     *
+     * @param[in] budget The maximum number of messages to handle.
+     *
+     * @return The number of messages handled.
+     */
+    size_t poll(size_t budget) {
+        return this->poll(budget, AsyncClock::read());
+    }
+};
+
+#endif  // _ASYNC_RETRY_QUEUE_H
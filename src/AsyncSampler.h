@@ -0,0 +1,381 @@
+/**
+ * @file AsyncSampler.h
+ *
+ * @brief Provides a phase-locked multi-channel sampling pipeline with
+ * decimation.
+ *
+ * @author boolscope
+ */
+#ifndef _ASYNC_SAMPLER_H
+#define _ASYNC_SAMPLER_H
+
+#include <Arduino.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__AVR__)
+#include <util/atomic.h>
+#endif
+
+#include "AsyncSpscRing.h"
+
+/**
+ * @struct AsyncSample
+ * @brief A raw sample as it travels through the ring buffer.
+ */
+struct AsyncSample {
+    uint8_t channel;
+    uint16_t value;
+};
+
+/**
+ * @class AsyncSampler
+ * @brief Samples several analog channels from one base clock and averages
+ * them in loop().
+ *
+ * The pipeline has two stages:
+ *
+ * - The sample stage, sample() or tick(), reads the channels that are due
+ *   and pushes the raw values into an AsyncSpscRing. Every channel runs at
+ *   the base rate divided by its own divider, so all rates stay locked to
+ *   one clock. sample() is meant to be called from a hardware timer
+ *   interrupt. tick() can be called from loop() as often as possible
+ *   instead: it advances its deadline by exactly one period (`next +=
+ *   period`), so loop load shows as jitter of single samples but never as
+ *   drift of the rate.
+ * - The decimation stage, process(), runs in loop(). It drains the ring in
+ *   batches and averages `decimation` raw samples of each channel into one
+ *   output value, which is handed to the output callback.
+ *
+ * Samples that do not fit into the ring are dropped and counted by
+ * getOverruns(). If tick() falls behind by more than one period, the missed
+ * base ticks are skipped, instead of being sampled in a burst, and counted
+ * by getMissedTicks(). The base tick counter wraps after 2^32 ticks; every
+ * channel keeps the tick it is due at and compares it with wrapping
+ * subtraction, so its phase survives the wrap.
+ *
+ * setChannel(), restart() and the counter getters may be called from loop()
+ * while sample() runs in an interrupt; on AVR they briefly disable
+ * interrupts, since 32-bit loads and channel updates are not atomic there.
+ *
+ * @code
+ * AsyncSampler<2, 64> sampler(1000);  // 1 kHz base clock
+ *
+ * void onValue(uint8_t channel, uint16_t value) { ... }
+ *
+ * void setup() {
+ *   sampler.setChannel(0, A0, 1, 10);   // 1 kHz, averaged to 100 Hz
+ *   sampler.setChannel(1, A1, 100, 4);  // 10 Hz, averaged to 2.5 Hz
+ *   sampler.setOutputCallback(onValue);
+ * }
+ *
+ * void loop() {
+ *   sampler.tick();
+ *   sampler.process();
+ * }
+ * @endcode
+ *
+ * @tparam Channels The number of channels.
+ * @tparam RingSize The number of ring buffer elements, a power of two.
+ */
+template <size_t Channels, size_t RingSize = 64>
+class AsyncSampler {
+public:
+    /** @brief Reads one raw sample from a pin. */
+    typedef int (*ReadFunction)(uint8_t pin);
+
+    /** @brief Receives one decimated value. */
+    typedef void (*OutputFunction)(uint8_t channel, uint16_t value);
+
+private:
+    /**
+     * @struct Channel
+     * @brief The configuration and decimation state of a channel.
+     */
+    struct Channel {
+        uint8_t pin;
+        uint16_t divider;
+        uint16_t decimation;
+        uint32_t due;
+        uint16_t pending;
+        uint32_t sum;
+        uint16_t value;
+        bool fresh;
+    };
+
+    /** @brief The channels. */
+    Channel channels[Channels];
+
+    /** @brief The raw samples on their way from sample() to process(). */
+    AsyncSpscRing<AsyncSample, RingSize> ring;
+
+    /** @brief The base period in microseconds. */
+    unsigned long period;
+
+    /** @brief The deadline of the next base tick in microseconds. */
+    unsigned long next = 0;
+
+    /** @brief Set once the base clock has a deadline. */
+    bool started = false;
+
+    /** @brief The number of base ticks since start, modulo 2^32. */
+    volatile uint32_t ticks = 0;
+
+    /** @brief The number of samples dropped because the ring was full. */
+    volatile unsigned long overruns = 0;
+
+    /** @brief The number of base ticks skipped by tick(). */
+    volatile unsigned long missedTicks = 0;
+
+    /** @brief Reads a pin. */
+    ReadFunction readFunction = analogRead;
+
+    /** @brief Receives the decimated values, may be nullptr. */
+    OutputFunction outputFunction = nullptr;
+
+    /** @brief Reads a counter that sample() writes from an interrupt.
+     *
+     * On AVR a 32-bit load takes several instructions and can tear, so
+     * interrupts are disabled around it. Elsewhere an aligned 32-bit load
+     * is atomic.
+     */
+    template <typename V>
+    static V load(const volatile V &value) {
+#if defined(__AVR__)
+        V result;
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            result = value;
+        }
+        return result;
+#else
+        return value;
+#endif
+    }
+
+public:
+    /** @brief Constructs a new AsyncSampler object.
+     *
+     * All channels are disabled until setChannel() is called.
+     *
+     * @param[in] period The base period in microseconds.
+     */
+    AsyncSampler(unsigned long period) : period(period == 0 ? 1 : period) {
+        for (size_t i = 0; i < Channels; i++) {
+            this->channels[i] = Channel();
+        }
+    }
+
+    /** @brief Configures a channel.
+     *
+     * @param[in] channel The channel index.
+     * @param[in] pin The analog pin.
+     * @param[in] divider The channel samples every `divider` base ticks,
+     * 0 disables it.
+     * @param[in] decimation The number of raw samples averaged into one
+     * output value, at least 1.
+     */
+    void setChannel(uint8_t channel, uint8_t pin, uint16_t divider,
+                    uint16_t decimation) {
+        Channel c = Channel();
+        c.pin = pin;
+        c.divider = divider;
+        c.decimation = decimation == 0 ? 1 : decimation;
+
+        // sample() may read the entry and write the tick counter from an
+        // interrupt, so both are accessed with interrupts disabled on AVR.
+#if defined(__AVR__)
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+#endif
+            c.due = this->ticks;
+            this->channels[channel] = c;
+#if defined(__AVR__)
+        }
+#endif
+    }
+
+    /** @brief Replaces analogRead(), e.g. with a faster register read.
+     *
+     * @param[in] fn The read function.
+     */
+    void setReadFunction(ReadFunction fn) {
+        this->readFunction = fn;
+    }
+
+    /** @brief Sets the function that receives the decimated values.
+     *
+     * @param[in] fn The function, or nullptr.
+     */
+    void setOutputCallback(OutputFunction fn) {
+        this->outputFunction = fn;
+    }
+
+    /** @brief Restarts the base clock at the given time.
+     *
+     * Without a restart, the clock starts at the first call to tick().
+     *
+     * @param[in] now The time of the next base tick in microseconds.
+     */
+    void restart(unsigned long now) {
+        this->next = now;
+        this->started = true;
+
+#if defined(__AVR__)
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+#endif
+            this->ticks = 0;
+            for (size_t i = 0; i < Channels; i++) {
+                this->channels[i].due = 0;
+            }
+#if defined(__AVR__)
+        }
+#endif
+    }
+
+    /** @brief Performs one base tick: samples every due channel.
+     *
+     * Call it from a timer interrupt running at the base rate, or use
+     * tick() to derive the base rate from micros(). Producer side.
+     *
+     * A channel whose due tick was skipped by tick() waits for its next
+     * due tick, so it stays in phase.
+     */
+    void sample() {
+        uint32_t t = this->ticks;
+        for (size_t i = 0; i < Channels; i++) {
+            Channel &c = this->channels[i];
+            uint32_t behind = t - c.due;
+            if (c.divider == 0 || (int32_t)behind < 0) {
+                continue;
+            }
+
+            uint32_t offset = behind % c.divider;
+            c.due = t - offset + c.divider;
+            if (offset != 0) {
+                continue;
+            }
+
+            AsyncSample s;
+            s.channel = i;
+            s.value = this->readFunction(c.pin);
+            if (!this->ring.push(s)) {
+                this->overruns = this->overruns + 1;
+            }
+        }
+
+        this->ticks = t + 1;
+    }
+
+    /** @brief Performs the base tick if it is due at the given time.
+     *
+     * @param[in] now The current time in microseconds.
+     *
+     * @retval true if a base tick was performed.
+     * @retval false otherwise.
+     */
+    bool tick(unsigned long now) {
+        if (!this->started) {
+            this->restart(now);
+        }
+
+        long late = (long)(now - this->next);
+        if (late < 0) {
+            return false;
+        }
+
+        // Skip, but count, the ticks that were missed entirely.
+        if ((unsigned long)late >= this->period) {
+            unsigned long missed = (unsigned long)late / this->period;
+            this->missedTicks = this->missedTicks + missed;
+            this->ticks = this->ticks + missed;
+            this->next += missed * this->period;
+        }
+
+        this->next += this->period;
+        this->sample();
+        return true;
+    }
+
+    /** @brief Performs the base tick if it is due.
+     *
+     * @retval true if a base tick was performed.
+     * @retval false otherwise.
+     */
+    bool tick() {
+        return this->tick(micros());
+    }
+
+    /** @brief Drains the ring buffer and runs the decimation stage.
+     *
+     * Consumer side; call it from loop().
+     *
+     * @return The number of raw samples processed.
+     */
+    size_t process() {
+        AsyncSample batch[16];
+        size_t total = 0;
+        size_t n;
+        while ((n = this->ring.read(batch, 16)) != 0) {
+            for (size_t i = 0; i < n; i++) {
+                Channel &c = this->channels[batch[i].channel];
+                c.sum += batch[i].value;
+                if (++c.pending < c.decimation) {
+                    continue;
+                }
+
+                c.value = (c.sum + c.decimation / 2) / c.decimation;
+                c.sum = 0;
+                c.pending = 0;
+                c.fresh = true;
+                if (this->outputFunction != nullptr) {
+                    this->outputFunction(batch[i].channel, c.value);
+                }
+            }
+
+            total += n;
+        }
+
+        return total;
+    }
+
+    /** @brief Retrieves the last decimated value of a channel and marks it
+     * as read.
+     *
+     * @param[in] channel The channel index.
+     *
+     * @return The value, 0 before the first one is complete.
+     */
+    uint16_t read(uint8_t channel) {
+        this->channels[channel].fresh = false;
+        return this->channels[channel].value;
+    }
+
+    /** @brief Checks if a channel has a value that has not been read.
+     *
+     * @param[in] channel The channel index.
+     *
+     * @return True if a new value is available.
+     */
+    bool isFresh(uint8_t channel) {
+        return this->channels[channel].fresh;
+    }
+
+    /** @brief Returns the number of samples that were dropped because the
+     * ring buffer was full, i.e. process() ran too rarely.
+     *
+     * @return The number of overruns.
+     */
+    unsigned long getOverruns() {
+        return load(this->overruns);
+    }
+
+    /** @brief Returns the number of base ticks that tick() skipped, i.e.
+     * tick() ran too rarely.
+     *
+     * @return The number of missed ticks.
+     */
+    unsigned long getMissedTicks() {
+        return load(this->missedTicks);
+    }
+};
+
+#endif  // _ASYNC_SAMPLER_H
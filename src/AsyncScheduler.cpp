@@ -0,0 +1,335 @@
+#include "AsyncScheduler.h"
+
+#include <Arduino.h>
+
+#include "AsyncClock.h"
+
+/**
+ * @brief Registers a timer with the scheduler.
+ *
+ * The timer is placed into the first free slot. Registering the same timer
+ * twice is rejected, so the timer is never polled twice per pass.
+ *
+ * @param[in] timer The timer to register.
+ * @param[in] name The name id of the timer.
+ *
+ * @return `true` if the timer was registered, `false` if it is already
+ * registered or the scheduler is full.
+ */
+bool AsyncScheduler::add(AsyncDelay &timer, uint16_t name) {
+    if (this->indexOf(timer) >= 0) {
+        return false;
+    }
+
+    for (unsigned char i = 0; i < CAPACITY; i++) {
+        if (this->timers[i] == nullptr) {
+            this->timers[i] = &timer;
+            this->names[i] = name;
+            this->stats[i] = AsyncTimerStats();
+            this->suspended[i] = false;
+            this->deferrable[i] = false;
+            this->generations[i]++;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Removes a timer from the scheduler.
+ *
+ * The slot becomes free; the slots of other timers do not change.
+ *
+ * @param[in] timer The timer to remove.
+ *
+ * @return `true` if the timer has been removed, `false` if it was not
+ * registered.
+ */
+bool AsyncScheduler::remove(AsyncDelay &timer) {
+    int index = this->indexOf(timer);
+    if (index < 0) {
+        return false;
+    }
+
+    this->timers[index] = nullptr;
+    return true;
+}
+
+/**
+ * @brief Finds the slot of a registered timer.
+ *
+ * @param[in] timer The timer to look for.
+ *
+ * @return The slot index, or -1 if the timer is not registered.
+ */
+int AsyncScheduler::indexOf(const AsyncDelay &timer) {
+    for (unsigned char i = 0; i < CAPACITY; i++) {
+        if (this->timers[i] == &timer) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Retrieves the timer registered in a slot.
+ *
+ * @param[in] index The slot index.
+ *
+ * @return The timer, or nullptr if the slot is free or out of range.
+ */
+AsyncDelay *AsyncScheduler::getTimer(unsigned char index) {
+    return index < CAPACITY ? this->timers[index] : nullptr;
+}
+
+/**
+ * @brief Retrieves the name id of a slot.
+ *
+ * @param[in] index The slot index, must be less than CAPACITY.
+ *
+ * @return The name id given to add(), 0 for unnamed timers.
+ */
+uint16_t AsyncScheduler::getName(unsigned char index) {
+    return this->names[index];
+}
+
+/**
+ * @brief Retrieves the statistics of a slot.
+ *
+ * @param[in] index The slot index, must be less than CAPACITY.
+ *
+ * @return The statistics collected for the slot.
+ */
+const AsyncTimerStats &AsyncScheduler::getStats(unsigned char index) {
+    return this->stats[index];
+}
+
+/**
+ * @brief Clears the statistics of all slots.
+ */
+void AsyncScheduler::resetStats() {
+    for (unsigned char i = 0; i < CAPACITY; i++) {
+        this->stats[i] = AsyncTimerStats();
+    }
+
+    this->statsGeneration++;
+}
+
+/**
+ * @brief Retrieves the generation of a slot.
+ *
+ * @param[in] index The slot index, must be less than CAPACITY.
+ *
+ * @return The number of times add() has used the slot, modulo 256.
+ */
+uint8_t AsyncScheduler::getGeneration(unsigned char index) {
+    return this->generations[index];
+}
+
+/**
+ * @brief Retrieves the generation of the statistics.
+ *
+ * @return The number of resetStats() calls, modulo 256.
+ */
+uint8_t AsyncScheduler::getStatsGeneration() {
+    return this->statsGeneration;
+}
+
+/**
+ * @brief Suspends or releases a slot.
+ *
+ * @param[in] index The slot index, must be less than CAPACITY.
+ * @param[in] suspend `true` to suspend, `false` to release.
+ */
+void AsyncScheduler::setSuspended(unsigned char index, bool suspend) {
+    this->suspended[index] = suspend;
+}
+
+/**
+ * @brief Checks if a slot is suspended.
+ *
+ * @param[in] index The slot index, must be less than CAPACITY.
+ *
+ * @return `true` if the slot is suspended.
+ */
+bool AsyncScheduler::isSuspended(unsigned char index) {
+    return this->suspended[index];
+}
+
+/**
+ * @brief Marks a slot as deferrable.
+ *
+ * The maximum deferral is clamped to AsyncDelay::MAX_INTERVAL.
+ *
+ * @param[in] index The slot index, must be less than CAPACITY.
+ * @param[in] deferrable `true` to make the slot deferrable.
+ * @param[in] maxDeferral The longest deferral in milliseconds, 0 for
+ * unlimited.
+ */
+void AsyncScheduler::setDeferrable(unsigned char index, bool deferrable,
+                                   unsigned long maxDeferral) {
+    this->deferrable[index] = deferrable;
+    this->maxDeferrals[index] = maxDeferral > AsyncDelay::MAX_INTERVAL
+                                    ? AsyncDelay::MAX_INTERVAL
+                                    : maxDeferral;
+}
+
+/**
+ * @brief Checks if a slot is deferrable.
+ *
+ * @param[in] index The slot index, must be less than CAPACITY.
+ *
+ * @return `true` if the slot is deferrable.
+ */
+bool AsyncScheduler::isDeferrable(unsigned char index) {
+    return this->deferrable[index];
+}
+
+/**
+ * @brief Calculates the time until the earliest running timer is due.
+ *
+ * @param[in] now The current time in milliseconds.
+ *
+ * @return The time in milliseconds, 0 if a timer is already due, or
+ * AsyncDelay::MAX_INTERVAL if no timer is running.
+ */
+unsigned long AsyncScheduler::getIdleTime(unsigned long now) {
+    int index;
+    return this->findEarliest(now, index);
+}
+
+/**
+ * @brief Finds the slot whose deadline ends the current idle time.
+ *
+ * @param[in] now The current time in milliseconds.
+ *
+ * @return The slot index, or -1 if no timer is running.
+ */
+int AsyncScheduler::getEarliest(unsigned long now) {
+    int index;
+    this->findEarliest(now, index);
+    return index;
+}
+
+/**
+ * @brief Finds the earliest deadline of all running timers.
+ *
+ * A deferrable slot is due at its deadline plus its maximum deferral, and
+ * never if the deferral is unlimited.
+ *
+ * @param[in] now The current time in milliseconds.
+ * @param[out] index Receives the slot of the deadline, or -1.
+ *
+ * @return The time until the deadline in milliseconds, 0 if it has passed,
+ * or AsyncDelay::MAX_INTERVAL if no timer is running.
+ */
+unsigned long AsyncScheduler::findEarliest(unsigned long now, int &index) {
+    unsigned long idle = ULONG_MAX;
+    index = -1;
+
+    for (unsigned char i = 0; i < CAPACITY; i++) {
+        AsyncDelay *timer = this->timers[i];
+        if (timer == nullptr || this->suspended[i] || timer->isPaused()) {
+            continue;
+        }
+
+        unsigned long interval = timer->getInterval();
+        if (interval == 0) {
+            continue;
+        }
+
+        if (this->deferrable[i]) {
+            if (this->maxDeferrals[i] == 0) {
+                continue;
+            }
+
+            interval += this->maxDeferrals[i];
+        }
+
+        unsigned long delta = timer->getDelta(now);
+        if (delta >= interval) {
+            if (delta <= timer->getDelta()) {
+                index = i;
+                return 0;
+            }
+
+            // Reset after `now` was read, see poll().
+            delta = 0;
+        }
+
+        if (interval - delta < idle) {
+            idle = interval - delta;
+            index = i;
+        }
+    }
+
+    return idle < AsyncDelay::MAX_INTERVAL ? idle : AsyncDelay::MAX_INTERVAL;
+}
+
+/**
+ * @brief Checks all registered timers and updates their statistics.
+ *
+ * The millisecond clock is read once per pass through AsyncClock::tick()
+ * and shared by all timers, so it is also available as AsyncClock::now() for
+ * the rest of the loop iteration. The
+ * delta is compared with the interval before isReady() is called, so idle
+ * timers cost a single getDelta() and the microsecond clock is read only for
+ * timers that are about to fire. Timers reset by a callback after the
+ * snapshot was taken are skipped until the next pass.
+ *
+ * @return The number of timers that fired.
+ */
+unsigned char AsyncScheduler::poll() {
+    unsigned char fired = 0;
+    unsigned long now = AsyncClock::tick();
+
+    for (unsigned char i = 0; i < CAPACITY; i++) {
+        AsyncDelay *timer = this->timers[i];
+        if (timer == nullptr || this->suspended[i]) {
+            continue;
+        }
+
+        unsigned long interval = timer->getInterval();
+        if (interval == 0) {
+            continue;
+        }
+
+        unsigned long delta = timer->getDelta(now);
+        if (delta < interval) {
+            continue;
+        }
+
+        // A timer reset by an earlier callback of this pass has a timestamp
+        // later than `now`, so getDelta(now) wrapped around and exceeds the
+        // time elapsed up to the current clock. It is not due yet.
+        if (delta > timer->getDelta()) {
+            continue;
+        }
+
+        // Paused timers are rejected by isReady() itself.
+        unsigned long start = micros();
+        if (!timer->isReady(now)) {
+            continue;
+        }
+
+        AsyncTimerStats &s = this->stats[i];
+        s.callbackTime += micros() - start;
+        s.fires++;
+
+        unsigned long lateness = delta - interval;
+        if (lateness >= interval) {
+            s.missed += lateness / interval;
+        }
+
+        s.lastLateness = lateness;
+        if (lateness > s.maxLateness) {
+            s.maxLateness = lateness;
+        }
+
+        fired++;
+    }
+
+    return fired;
+}
@@ -0,0 +1,273 @@
+/**
+ * @file AsyncScheduler.h
+ *
+ * @brief Provides a scheduler that polls a fixed set of AsyncDelay objects
+ * and collects runtime statistics for each of them.
+ *
+ * @author boolscope
+ */
+#ifndef _ASYNC_SCHEDULER_H
+#define _ASYNC_SCHEDULER_H
+
+#include <stdint.h>
+
+#include "AsyncDelay.h"
+#include "AsyncName.h"
+
+/**
+ * @brief The maximum number of timers a scheduler can hold.
+ *
+ * Every slot costs a pointer plus the statistics record, so the default is
+ * kept small. Define it before including this header to change it.
+ */
+#ifndef ASYNC_SCHEDULER_CAPACITY
+#define ASYNC_SCHEDULER_CAPACITY 8
+#endif
+
+/**
+ * @struct AsyncTimerStats
+ * @brief Runtime statistics collected by the scheduler for a single timer.
+ */
+struct AsyncTimerStats {
+    /** @brief The number of times the timer has fired. */
+    unsigned long fires = 0;
+
+    /** @brief The number of whole periods skipped because of late polling.
+     */
+    unsigned long missed = 0;
+
+    /** @brief The largest observed lateness in milliseconds. */
+    unsigned long maxLateness = 0;
+
+    /** @brief The lateness of the most recent fire in milliseconds. */
+    unsigned long lastLateness = 0;
+
+    /** @brief The total time spent in the callback in microseconds. */
+    unsigned long callbackTime = 0;
+};
+
+/**
+ * @class AsyncScheduler
+ * @brief Polls registered AsyncDelay objects and keeps statistics for them.
+ *
+ * The scheduler does not own the timers, it only keeps pointers to them.
+ * Every call to poll() checks all registered timers with isReady(), so the
+ * timers' callbacks are invoked from the scheduler. Slots are stable: a timer
+ * keeps its slot index until it is removed, which allows other modules to
+ * keep per-slot data next to the scheduler.
+ *
+ * @code
+ * AsyncDelay blink(500);
+ * AsyncScheduler scheduler;
+ *
+ * void setup() {
+ *   blink.setCallback(toggleLed);
+ *   scheduler.add(blink);
+ * }
+ *
+ * void loop() {
+ *   scheduler.poll();
+ * }
+ * @endcode
+ */
+class AsyncScheduler {
+private:
+    /** @brief Registered timers, nullptr marks a free slot. */
+    AsyncDelay *timers[ASYNC_SCHEDULER_CAPACITY] = {};
+
+    /** @brief Statistics of the timer in the slot with the same index. */
+    AsyncTimerStats stats[ASYNC_SCHEDULER_CAPACITY];
+
+    /** @brief Name ids (see ASYNC_NAME()) of the registered timers. */
+    uint16_t names[ASYNC_SCHEDULER_CAPACITY] = {};
+
+    /** @brief Slots that poll() skips, see setSuspended(). */
+    bool suspended[ASYNC_SCHEDULER_CAPACITY] = {};
+
+    /** @brief Slots that do not limit the idle time, see setDeferrable(). */
+    bool deferrable[ASYNC_SCHEDULER_CAPACITY] = {};
+
+    /** @brief The maximum deferral of each deferrable slot, 0 = unlimited.
+     */
+    unsigned long maxDeferrals[ASYNC_SCHEDULER_CAPACITY] = {};
+
+    /** @brief Incremented whenever add() assigns the slot to a timer. */
+    uint8_t generations[ASYNC_SCHEDULER_CAPACITY] = {};
+
+    /** @brief Incremented by resetStats(). */
+    uint8_t statsGeneration = 0;
+
+    /** @brief Finds the earliest deadline, see getIdleTime(). */
+    unsigned long findEarliest(unsigned long now, int &index);
+
+public:
+    // The number of slots in the scheduler.
+    static const unsigned char CAPACITY = ASYNC_SCHEDULER_CAPACITY;
+
+    /** @brief Registers a timer with the scheduler.
+     *
+     * The timer is placed into the first free slot and its statistics are
+     * cleared. The timer itself is not reset.
+     *
+     * @param[in] timer The timer to register.
+     * @param[in] name The name id of the timer, usually ASYNC_NAME("...").
+     * Defaults to 0 (unnamed).
+     *
+     * @retval true if the timer was registered.
+     * @retval false if it is already registered or there is no free slot.
+     */
+    bool add(AsyncDelay &timer, uint16_t name = 0);
+
+    /** @brief Removes a timer from the scheduler.
+     *
+     * @param[in] timer The timer to remove.
+     *
+     * @retval true if the timer was registered and has been removed.
+     * @retval false otherwise.
+     */
+    bool remove(AsyncDelay &timer);
+
+    /** @brief Finds the slot of a registered timer.
+     *
+     * @param[in] timer The timer to look for.
+     *
+     * @return The slot index, or -1 if the timer is not registered.
+     */
+    int indexOf(const AsyncDelay &timer);
+
+    /** @brief Retrieves the timer registered in a slot.
+     *
+     * @param[in] index The slot index.
+     *
+     * @return The timer, or nullptr if the slot is free or out of range.
+     */
+    AsyncDelay *getTimer(unsigned char index);
+
+    /** @brief Retrieves the name id of a slot.
+     *
+     * @param[in] index The slot index, must be less than CAPACITY.
+     *
+     * @return The name id given to add(), 0 for unnamed timers.
+     */
+    uint16_t getName(unsigned char index);
+
+    /** @brief Retrieves the statistics of a slot.
+     *
+     * @param[in] index The slot index, must be less than CAPACITY.
+     *
+     * @return The statistics collected for the slot.
+     */
+    const AsyncTimerStats &getStats(unsigned char index);
+
+    /** @brief Clears the statistics of all slots.
+     *
+     * @return void
+     */
+    void resetStats();
+
+    /** @brief Retrieves the generation of a slot.
+     *
+     * The generation changes whenever add() places a timer into the slot,
+     * so modules that keep per-slot data next to the scheduler can tell a
+     * reused slot from the one they have seen and drop their stale data.
+     *
+     * @param[in] index The slot index, must be less than CAPACITY.
+     *
+     * @return The generation, wrapping after 255.
+     */
+    uint8_t getGeneration(unsigned char index);
+
+    /** @brief Retrieves the generation of the statistics.
+     *
+     * The generation changes whenever resetStats() clears the statistics,
+     * so modules that measure the growth of a counter know when to start
+     * again from zero.
+     *
+     * @return The generation, wrapping after 255.
+     */
+    uint8_t getStatsGeneration();
+
+    /** @brief Suspends or releases a slot.
+     *
+     * A suspended timer is not polled, so its callback does not run, but
+     * the timer itself is left untouched: it fires on the first poll()
+     * after it is released if its interval has elapsed meanwhile.
+     *
+     * @param[in] index The slot index, must be less than CAPACITY.
+     * @param[in] suspend True to suspend, false to release.
+     *
+     * @return void
+     */
+    void setSuspended(unsigned char index, bool suspend);
+
+    /** @brief Checks if a slot is suspended.
+     *
+     * @param[in] index The slot index, must be less than CAPACITY.
+     *
+     * @return True if the slot is suspended.
+     */
+    bool isSuspended(unsigned char index);
+
+    /** @brief Marks a slot as deferrable.
+     *
+     * A deferrable timer never shortens the idle time reported by
+     * getIdleTime(), so it does not wake the system on its own. It still
+     * fires in the first poll() after its deadline, i.e. whenever the CPU
+     * is awake for another reason. With a maximum deferral it does wake
+     * the system once its deadline is that much overdue.
+     *
+     * @param[in] index The slot index, must be less than CAPACITY.
+     * @param[in] deferrable True to make the slot deferrable.
+     * @param[in] maxDeferral The longest deferral in milliseconds. Defaults
+     * to 0 (unlimited).
+     *
+     * @return void
+     */
+    void setDeferrable(unsigned char index, bool deferrable,
+                       unsigned long maxDeferral = 0);
+
+    /** @brief Checks if a slot is deferrable.
+     *
+     * @param[in] index The slot index, must be less than CAPACITY.
+     *
+     * @return True if the slot is deferrable.
+     */
+    bool isDeferrable(unsigned char index);
+
+    /** @brief Calculates the time until the earliest timer is due.
+     *
+     * Free slots, suspended slots, paused timers and timers with a zero
+     * interval are ignored. Deferrable slots only count with their deadline
+     * plus their maximum deferral, or not at all if it is unlimited.
+     *
+     * @param[in] now The current time in milliseconds.
+     *
+     * @return The time in milliseconds, 0 if a timer is due, or
+     * AsyncDelay::MAX_INTERVAL if no timer is running.
+     */
+    unsigned long getIdleTime(unsigned long now);
+
+    /** @brief Finds the slot whose deadline ends the current idle time.
+     *
+     * Uses the same rules as getIdleTime(). On a tie the lowest slot wins.
+     *
+     * @param[in] now The current time in milliseconds.
+     *
+     * @return The slot index, or -1 if no timer is running.
+     */
+    int getEarliest(unsigned long now);
+
+    /** @brief Checks all registered timers.
+     *
+     * Calls isReady() on every timer whose interval has elapsed, which
+     * invokes its callback and resets it. For every fired timer the
+     * statistics are updated: the fire counter, the number of periods that
+     * were skipped entirely, the largest lateness and the time spent in the
+     * callback.
+     *
+     * @return The number of timers that fired.
+     */
+    unsigned char poll();
+};
+
+#endif  // _ASYNC_SCHEDULER_H
@@ -0,0 +1,224 @@
+#include "AsyncSharedStats.h"
+
+#if defined(__linux__)
+
+#include <Arduino.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/**
+ * @brief Returns the histogram bin of a lateness value.
+ *
+ * @param[in] lateness The lateness in milliseconds.
+ *
+ * @return The bin index.
+ */
+static unsigned char latenessBin(unsigned long lateness) {
+    unsigned char bin = 0;
+    while (lateness != 0 && bin < ASYNC_SHARED_BINS - 1) {
+        lateness >>= 1;
+        bin++;
+    }
+
+    return bin;
+}
+
+/**
+ * @brief Constructs a new AsyncSharedStats object.
+ *
+ * The segment is not created until open() is called.
+ *
+ * @param[in] scheduler The scheduler whose statistics are published.
+ * @param[in] name The shared-memory object name.
+ */
+AsyncSharedStats::AsyncSharedStats(AsyncScheduler &scheduler, const char *name)
+    : scheduler(scheduler), name(name) {}
+
+/**
+ * @brief Unmaps and removes the segment.
+ */
+AsyncSharedStats::~AsyncSharedStats() {
+    this->close();
+}
+
+/**
+ * @brief Creates and maps the shared-memory segment.
+ *
+ * An existing object with the same name is truncated and reinitialized.
+ *
+ * @return `true` if the segment is ready, `false` otherwise.
+ */
+bool AsyncSharedStats::open() {
+    if (this->header != nullptr) {
+        return true;
+    }
+
+    size_t size = segmentSize(AsyncScheduler::CAPACITY);
+    int fd = shm_open(this->name, O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        return false;
+    }
+
+    if (ftruncate(fd, size) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    void *p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        return false;
+    }
+
+    memset(p, 0, size);
+    this->header = (AsyncSharedHeader *)p;
+    this->header->version = VERSION;
+    this->header->capacity = AsyncScheduler::CAPACITY;
+    __atomic_store_n(&this->header->magic, MAGIC, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+/**
+ * @brief Unmaps and removes the shared-memory segment.
+ */
+void AsyncSharedStats::close() {
+    if (this->header == nullptr) {
+        return;
+    }
+
+    munmap(this->header, segmentSize(AsyncScheduler::CAPACITY));
+    shm_unlink(this->name);
+    this->header = nullptr;
+}
+
+/**
+ * @brief Bins the fires since the last call.
+ *
+ * The histogram of a reused slot, and all histograms after resetStats(),
+ * start again from zero. If a slot fired more than once since the last call,
+ * all its fires go into the bin of the latest lateness.
+ */
+void AsyncSharedStats::record() {
+    uint8_t generation = this->scheduler.getStatsGeneration();
+    bool reset = generation != this->statsGeneration;
+    this->statsGeneration = generation;
+
+    for (unsigned char i = 0; i < AsyncScheduler::CAPACITY; i++) {
+        uint8_t slot = this->scheduler.getGeneration(i);
+        if (reset || slot != this->generations[i]) {
+            memset(this->histograms[i], 0, sizeof(this->histograms[i]));
+            this->seenFires[i] = 0;
+            this->generations[i] = slot;
+        }
+
+        const AsyncTimerStats &s = this->scheduler.getStats(i);
+        if (s.fires != this->seenFires[i]) {
+            this->histograms[i][latenessBin(s.lastLateness)] +=
+                s.fires - this->seenFires[i];
+            this->seenFires[i] = s.fires;
+        }
+    }
+}
+
+/**
+ * @brief Polls the scheduler and bins the lateness of every fire.
+ *
+ * A slot fires at most once per AsyncScheduler::poll(), so binning right
+ * after it sees every lateness.
+ *
+ * @return The number of timers that fired.
+ */
+unsigned char AsyncSharedStats::poll() {
+    unsigned char fired = this->scheduler.poll();
+    this->record();
+    return fired;
+}
+
+/**
+ * @brief Copies the current statistics into the segment.
+ *
+ * The sequence counter is made odd before and even after the copy; readers
+ * use it to detect torn snapshots. There is only one writer, so no atomic
+ * read-modify-write is needed.
+ */
+void AsyncSharedStats::publish() {
+    if (this->header == nullptr) {
+        return;
+    }
+
+    this->record();
+
+    AsyncSharedTimer *records = (AsyncSharedTimer *)(this->header + 1);
+    uint32_t sequence = this->header->sequence;
+
+    __atomic_store_n(&this->header->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    for (unsigned char i = 0; i < AsyncScheduler::CAPACITY; i++) {
+        AsyncSharedTimer &r = records[i];
+        AsyncDelay *timer = this->scheduler.getTimer(i);
+        if (timer == nullptr) {
+            r.active = 0;
+            continue;
+        }
+
+        const AsyncTimerStats &s = this->scheduler.getStats(i);
+        memcpy(r.histogram, this->histograms[i], sizeof(r.histogram));
+        r.active = 1;
+        r.name = this->scheduler.getName(i);
+        r.interval = timer->getInterval();
+        r.fires = s.fires;
+        r.missed = s.missed;
+        r.maxLateness = s.maxLateness;
+        r.lastLateness = s.lastLateness;
+        r.callbackTime = s.callbackTime;
+    }
+
+    this->header->publishedMicros = micros();
+
+    __atomic_store_n(&this->header->sequence, sequence + 2, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Takes a consistent snapshot of a mapped segment.
+ *
+ * Classic seqlock read side: the copy is retried while the publisher is
+ * writing or has written during the copy, up to READ_RETRIES times. The
+ * publisher is never delayed.
+ *
+ * @param[in] segment The mapped segment.
+ * @param[out] buffer The destination.
+ * @param[in] size The size of the destination in bytes.
+ *
+ * @return `true` if a consistent snapshot was copied, `false` otherwise.
+ */
+bool AsyncSharedStats::read(const AsyncSharedHeader *segment, void *buffer,
+                            size_t size) {
+    if (__atomic_load_n(&segment->magic, __ATOMIC_ACQUIRE) != MAGIC ||
+        segment->version != VERSION ||
+        size < segmentSize(segment->capacity)) {
+        return false;
+    }
+
+    size_t length = segmentSize(segment->capacity);
+    for (unsigned int attempt = 0; attempt < READ_RETRIES; attempt++) {
+        uint32_t before = __atomic_load_n(&segment->sequence, __ATOMIC_ACQUIRE);
+        if (before & 1) {
+            continue;
+        }
+
+        memcpy(buffer, segment, length);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+        uint32_t after = __atomic_load_n(&segment->sequence, __ATOMIC_RELAXED);
+        if (before == after) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+#endif  // __linux__
@@ -0,0 +1,189 @@
+/**
+ * @file AsyncSharedStats.h
+ *
+ * @brief Publishes AsyncScheduler statistics into a POSIX shared-memory
+ * segment so that other processes can monitor them (Linux hosts only).
+ *
+ * @author boolscope
+ */
+#ifndef _ASYNC_SHARED_STATS_H
+#define _ASYNC_SHARED_STATS_H
+
+#if defined(__linux__)
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "AsyncScheduler.h"
+
+// The number of lateness histogram bins per timer.
+#define ASYNC_SHARED_BINS 16
+
+/**
+ * @struct AsyncSharedTimer
+ * @brief The published record of a single scheduler slot.
+ *
+ * Lateness histogram bin 0 counts fires that were on time, bin `k` counts
+ * fires that were between 2^(k-1) and 2^k - 1 milliseconds late. The last
+ * bin also collects everything beyond it.
+ */
+struct AsyncSharedTimer {
+    uint32_t active;
+    uint32_t name;
+    uint32_t interval;
+    uint32_t fires;
+    uint32_t missed;
+    uint32_t maxLateness;
+    uint32_t lastLateness;
+    uint64_t callbackTime;
+    uint32_t histogram[ASYNC_SHARED_BINS];
+};
+
+/**
+ * @struct AsyncSharedHeader
+ * @brief The header of the shared segment, followed by `capacity`
+ * AsyncSharedTimer records.
+ *
+ * `sequence` is a seqlock: it is odd while the publisher is writing. A reader
+ * copies the segment and retries if the sequence was odd or changed during
+ * the copy (see AsyncSharedStats::read()).
+ */
+struct AsyncSharedHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t sequence;
+    uint32_t capacity;
+    uint64_t publishedMicros;
+};
+
+/**
+ * @class AsyncSharedStats
+ * @brief Copies scheduler statistics into a seqlock-protected shared-memory
+ * segment.
+ *
+ * The timer thread only pays for a short copy in publish(); the readers never
+ * block it, no matter how often they sample. The lateness histograms are
+ * kept here and built by poll(), which polls the scheduler and bins every
+ * fire with its own lateness, so publish() can run at any lower rate. Fires
+ * that only publish() sees, because the scheduler was polled directly, are
+ * binned with the lateness of the latest fire.
+ *
+ * @code
+ * AsyncSharedStats shared(scheduler, "/asyncdelay");
+ * shared.open();
+ *
+ * while (true) {
+ *   shared.poll();  // instead of scheduler.poll()
+ *   if (publishDelay.isReady()) {
+ *     shared.publish();
+ *   }
+ * }
+ * @endcode
+ *
+ * Run `shmstat /asyncdelay` (built by `make host`) to watch the values.
+ */
+class AsyncSharedStats {
+private:
+    /** @brief The scheduler whose statistics are published. */
+    AsyncScheduler &scheduler;
+
+    /** @brief The name of the shared-memory object. */
+    const char *name;
+
+    /** @brief The mapped segment, nullptr until open() succeeds. */
+    AsyncSharedHeader *header = nullptr;
+
+    /** @brief The fire counter of each slot that was last binned. */
+    unsigned long seenFires[AsyncScheduler::CAPACITY] = {};
+
+    /** @brief The lateness histogram of each slot. */
+    uint32_t histograms[AsyncScheduler::CAPACITY][ASYNC_SHARED_BINS] = {};
+
+    /** @brief The scheduler generation each histogram belongs to. */
+    uint8_t generations[AsyncScheduler::CAPACITY] = {};
+
+    /** @brief The scheduler statistics generation of the histograms. */
+    uint8_t statsGeneration = 0;
+
+    /** @brief Bins the fires since the last call. */
+    void record();
+
+public:
+    // Identifies an AsyncSharedStats segment.
+    static const uint32_t MAGIC = 0x41444C59;  // "ADLY"
+
+    // The segment layout version.
+    static const uint32_t VERSION = 2;
+
+    // The number of attempts read() makes before it gives up.
+    static const unsigned int READ_RETRIES = 1000;
+
+    /** @brief Constructs a new AsyncSharedStats object.
+     *
+     * @param[in] scheduler The scheduler whose statistics are published.
+     * @param[in] name The shared-memory object name, e.g. "/asyncdelay".
+     */
+    AsyncSharedStats(AsyncScheduler &scheduler, const char *name);
+
+    /** @brief Unmaps and removes the segment.
+     */
+    ~AsyncSharedStats();
+
+    /** @brief Creates and maps the shared-memory segment.
+     *
+     * @retval true if the segment is ready.
+     * @retval false if it could not be created or mapped.
+     */
+    bool open();
+
+    /** @brief Unmaps and removes the shared-memory segment.
+     *
+     * @return void
+     */
+    void close();
+
+    /** @brief Polls the scheduler and bins the lateness of every fire.
+     *
+     * @return The number of timers that fired.
+     */
+    unsigned char poll();
+
+    /** @brief Copies the current statistics into the segment.
+     *
+     * Does nothing if the segment is not open.
+     *
+     * @return void
+     */
+    void publish();
+
+    /** @brief Returns the size of a segment with the given capacity.
+     *
+     * @param[in] capacity The number of timer records.
+     *
+     * @return The segment size in bytes.
+     */
+    static size_t segmentSize(uint32_t capacity) {
+        return sizeof(AsyncSharedHeader) + capacity * sizeof(AsyncSharedTimer);
+    }
+
+    /** @brief Takes a consistent snapshot of a mapped segment.
+     *
+     * Gives up after READ_RETRIES attempts, so a publisher that stopped in
+     * the middle of an update does not hang the reader.
+     *
+     * @param[in] segment The mapped segment.
+     * @param[out] buffer The destination, at least segmentSize(capacity)
+     * bytes.
+     * @param[in] size The size of the destination in bytes.
+     *
+     * @retval true if a consistent snapshot was copied.
+     * @retval false if the segment is invalid, the buffer too small or no
+     * consistent snapshot was seen.
+     */
+    static bool read(const AsyncSharedHeader *segment, void *buffer,
+                     size_t size);
+};
+
+#endif  // __linux__
+
+#endif  // _ASYNC_SHARED_STATS_H
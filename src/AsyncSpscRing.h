@@ -0,0 +1,164 @@
+/**
+ * @file AsyncSpscRing.h
+ *
+ * @brief Provides a lock-free single-producer/single-consumer ring buffer.
+ *
+ * @author boolscope
+ */
+#ifndef _ASYNC_SPSC_RING_H
+#define _ASYNC_SPSC_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @class AsyncSpscRing
+ * @brief A fixed-size FIFO shared by exactly one producer and one consumer.
+ *
+ * The producer (typically an interrupt handler) only writes `head` and the
+ * consumer (typically loop()) only writes `tail`, so neither side needs to
+ * disable interrupts. Each index is published with a release store after
+ * the element it covers has been written, and read with an acquire load.
+ * On AVR the indices are single bytes, so their loads and stores are
+ * atomic; this limits N to 256 there.
+ *
+ * One element is kept empty to tell a full ring from an empty one, so the
+ * ring holds N - 1 elements.
+ *
+ * @code
+ * AsyncSpscRing<uint16_t, 64> samples;
+ *
+ * ISR(ADC_vect) {
+ *   samples.push(ADC);
+ * }
+ *
+ * void loop() {
+ *   uint16_t batch[16];
+ *   size_t n = samples.read(batch, 16);
+ * }
+ * @endcode
+ *
+ * @tparam T The element type, copied by value.
+ * @tparam N The number of elements, a power of two.
+ */
+template <typename T, size_t N>
+class AsyncSpscRing {
+public:
+#if defined(__AVR__)
+    // The index type, a single byte so that it is accessed atomically.
+    typedef uint8_t Index;
+#else
+    // The index type.
+    typedef size_t Index;
+#endif
+
+private:
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "N must be a power of two");
+    static_assert((size_t)(Index)(N - 1) == N - 1, "N is too large");
+
+    // Maps an index to an element.
+    static const Index MASK = N - 1;
+
+    /** @brief The elements. */
+    T buffer[N];
+
+    /** @brief The next element to write, owned by the producer. */
+    volatile Index head = 0;
+
+    /** @brief The next element to read, owned by the consumer. */
+    volatile Index tail = 0;
+
+    /** @brief Reads an index written by the other side. */
+    static Index load(volatile Index &index) {
+        return __atomic_load_n(&index, __ATOMIC_ACQUIRE);
+    }
+
+    /** @brief Publishes an index to the other side. */
+    static void store(volatile Index &index, Index value) {
+        __atomic_store_n(&index, value, __ATOMIC_RELEASE);
+    }
+
+public:
+    // The number of elements the ring holds.
+    static const size_t CAPACITY = N - 1;
+
+    /** @brief Appends an element. Producer side only.
+     *
+     * @param[in] value The element.
+     *
+     * @retval true if the element was stored.
+     * @retval false if the ring is full.
+     */
+    bool push(const T &value) {
+        Index h = this->head;
+        Index next = (h + 1) & MASK;
+        if (next == load(this->tail)) {
+            return false;
+        }
+
+        this->buffer[h] = value;
+        store(this->head, next);
+        return true;
+    }
+
+    /** @brief Removes the oldest element. Consumer side only.
+     *
+     * @param[out] value Receives the element.
+     *
+     * @retval true if an element was removed.
+     * @retval false if the ring is empty.
+     */
+    bool pop(T &value) {
+        Index t = this->tail;
+        if (t == load(this->head)) {
+            return false;
+        }
+
+        value = this->buffer[t];
+        store(this->tail, (t + 1) & MASK);
+        return true;
+    }
+
+    /** @brief Removes up to `max` elements in one go. Consumer side only.
+     *
+     * The producer index is read once, so the batch costs a single
+     * synchronization however many elements it moves.
+     *
+     * @param[out] values Receives the elements, oldest first.
+     * @param[in] max The capacity of `values`.
+     *
+     * @return The number of elements removed.
+     */
+    size_t read(T *values, size_t max) {
+        Index t = this->tail;
+        Index h = load(this->head);
+        size_t n = 0;
+        while (t != h && n < max) {
+            values[n++] = this->buffer[t];
+            t = (t + 1) & MASK;
+        }
+
+        store(this->tail, t);
+        return n;
+    }
+
+    /** @brief Returns the number of stored elements.
+     *
+     * Exact on the consumer side; the producer may add more at any time.
+     *
+     * @return The number of elements.
+     */
+    size_t available() {
+        return (Index)(load(this->head) - this->tail) & MASK;
+    }
+
+    /** @brief Checks if the ring is empty. Consumer side only.
+     *
+     * @return True if no element is stored.
+     */
+    bool isEmpty() {
+        return this->tail == load(this->head);
+    }
+};
+
+#endif  // _ASYNC_SPSC_RING_H
@@ -0,0 +1,332 @@
+#include "AsyncTdma.h"
+
+/**
+ * @brief Constructs a new AsyncTdma object.
+ *
+ * The frame length estimate starts at the nominal beacon period.
+ *
+ * @param[in] beaconPeriod The nominal beacon period in microseconds.
+ * @param[in] slotLength The slot length in microseconds.
+ * @param[in] slots The number of slots per frame.
+ */
+AsyncTdma::AsyncTdma(unsigned long beaconPeriod, unsigned long slotLength,
+                     uint8_t slots)
+    : nominal(beaconPeriod == 0 ? 1 : beaconPeriod),
+      slotLength(slotLength == 0 ? 1 : slotLength),
+      slots(slots < NONE ? slots : NONE - 1),
+      period((unsigned long long)this->nominal << 8) {}
+
+/**
+ * @brief Sets the function that is called at every slot start.
+ *
+ * @param[in] fn The function, or nullptr.
+ */
+void AsyncTdma::setSlotCallback(AsyncSlotFunction fn) {
+    this->slotFunction = fn;
+}
+
+/**
+ * @brief Captures a beacon at the current time.
+ */
+void AsyncTdma::onBeacon() {
+    this->onBeacon(micros());
+}
+
+/**
+ * @brief Captures a beacon.
+ *
+ * Producer side of the ring. If the ring is full, the beacon is dropped;
+ * the frame then runs on the estimate until the next one.
+ *
+ * @param[in] timestamp The reception time in microseconds.
+ */
+void AsyncTdma::onBeacon(unsigned long timestamp) {
+    this->beacons.push(timestamp);
+}
+
+/**
+ * @brief Returns the local length of a slot.
+ *
+ * @return The slot length scaled by the estimated rate, in 1/256 µs.
+ */
+unsigned long long AsyncTdma::getLocalSlot() {
+    return (unsigned long long)this->slotLength * this->period /
+           this->nominal;
+}
+
+/**
+ * @brief Anchors the frame to a beacon unless it is rejected.
+ *
+ * The number of frames since the last beacon is rounded from the distance,
+ * so missed beacons do not distort the period measurement. A beacon less
+ * than half a period after the last one, or one whose period is off by
+ * more than the tolerance, is rejected.
+ *
+ * @param[in] timestamp The reception time in microseconds.
+ *
+ * @return `true` if the beacon was accepted.
+ */
+bool AsyncTdma::processBeacon(unsigned long timestamp) {
+    if (!this->synced) {
+        this->anchor = timestamp;
+        this->anchorFraction = 0;
+        this->frame++;
+        this->lastBeacon = timestamp;
+        this->beaconFrame = this->frame;
+        this->synced = true;
+        return true;
+    }
+
+    unsigned long interval = timestamp - this->lastBeacon;
+    unsigned long frames = (interval + this->nominal / 2) / this->nominal;
+    if (frames == 0) {
+        return false;
+    }
+
+    unsigned long long nominalQ8 = (unsigned long long)this->nominal << 8;
+    unsigned long long measured =
+        ((unsigned long long)interval << 8) / frames;
+    long long deviation = (long long)(measured - nominalQ8);
+    unsigned long long tolerance = nominalQ8 >> TOLERANCE_SHIFT;
+    if (deviation > (long long)tolerance ||
+        -deviation > (long long)tolerance) {
+        return false;
+    }
+
+    long long error = (long long)(measured - this->period);
+    this->period += error / (1 << GAIN_SHIFT);
+
+    // A frame that was already advanced on the estimate keeps its number.
+    unsigned long f = this->beaconFrame + frames;
+    if ((long)(f - this->frame) > 0) {
+        this->frame = f;
+    }
+
+    this->anchor = timestamp;
+    this->anchorFraction = 0;
+    this->lastBeacon = timestamp;
+    this->beaconFrame = this->frame;
+    return true;
+}
+
+/**
+ * @brief Processes captured beacons and advances the frame.
+ *
+ * @return `true` if a beacon was accepted.
+ */
+bool AsyncTdma::update() {
+    return this->update(micros());
+}
+
+/**
+ * @brief Processes captured beacons and advances the frame at the given
+ * time.
+ *
+ * Frames that end without a beacon are advanced by the estimated length,
+ * keeping the fraction of a microsecond. After MAX_MISSED of them the sync
+ * is lost.
+ *
+ * @param[in] now The current time in microseconds.
+ *
+ * @return `true` if a beacon was accepted.
+ */
+bool AsyncTdma::update(unsigned long now) {
+    bool accepted = false;
+    unsigned long timestamp;
+    while (this->beacons.pop(timestamp)) {
+        if (this->processBeacon(timestamp)) {
+            accepted = true;
+        }
+    }
+
+    while (this->synced && (long)(now - this->anchor) >= 0) {
+        unsigned long long end = this->period + this->anchorFraction;
+        if (((unsigned long long)(now - this->anchor) << 8) < end) {
+            break;
+        }
+
+        this->anchor += (unsigned long)(end >> 8);
+        this->anchorFraction = (uint8_t)(end & 0xFF);
+        this->frame++;
+        if (this->frame - this->beaconFrame > MAX_MISSED) {
+            this->synced = false;
+        }
+    }
+
+    return accepted;
+}
+
+/**
+ * @brief Updates the frame and calls the slot callback if a new slot has
+ * started.
+ *
+ * @return The slot that started, or NONE.
+ */
+uint8_t AsyncTdma::poll() {
+    return this->poll(micros());
+}
+
+/**
+ * @brief Updates the frame and calls the slot callback if a new slot has
+ * started at the given time.
+ *
+ * A slot fires only if it comes after the last fired one in frame order,
+ * so a beacon that moves the frame back never repeats a slot.
+ *
+ * @param[in] now The current time in microseconds.
+ *
+ * @return The slot that started, or NONE.
+ */
+uint8_t AsyncTdma::poll(unsigned long now) {
+    this->update(now);
+
+    uint8_t slot = this->getSlot(now);
+    if (slot == NONE) {
+        return NONE;
+    }
+
+    long frames = (long)(this->frame - this->firedFrame);
+    if (this->firedSlot != NONE &&
+        (frames < 0 || (frames == 0 && slot <= this->firedSlot))) {
+        return NONE;
+    }
+
+    this->firedFrame = this->frame;
+    this->firedSlot = slot;
+    if (this->slotFunction != nullptr) {
+        this->slotFunction(slot);
+    }
+
+    return slot;
+}
+
+/**
+ * @brief Checks if the frame follows the beacons.
+ *
+ * @return `true` while synchronized.
+ */
+bool AsyncTdma::isSynced() {
+    return this->synced;
+}
+
+/**
+ * @brief Retrieves the active slot.
+ *
+ * @param[in] now The current time in microseconds.
+ *
+ * @return The slot, or NONE if not synchronized, before the frame or in the
+ * guard time.
+ */
+uint8_t AsyncTdma::getSlot(unsigned long now) {
+    if (!this->synced || (long)(now - this->anchor) < 0) {
+        return NONE;
+    }
+
+    unsigned long long elapsed = (unsigned long long)(now - this->anchor)
+                                 << 8;
+    if (elapsed < this->anchorFraction) {
+        return NONE;
+    }
+
+    elapsed -= this->anchorFraction;
+    if (elapsed >= this->period) {
+        elapsed %= this->period;
+    }
+
+    unsigned long long slot = elapsed / this->getLocalSlot();
+    return slot < this->slots ? (uint8_t)slot : NONE;
+}
+
+/**
+ * @brief Retrieves the active slot.
+ *
+ * @return The slot, or NONE.
+ */
+uint8_t AsyncTdma::getSlot() {
+    return this->getSlot(micros());
+}
+
+/**
+ * @brief Retrieves the start of a slot in the current frame.
+ *
+ * @param[in] slot The slot.
+ *
+ * @return The local start time in microseconds.
+ */
+unsigned long AsyncTdma::getSlotStart(uint8_t slot) {
+    unsigned long long offset = this->anchorFraction +
+                                slot * this->getLocalSlot();
+    return this->anchor + (unsigned long)(offset >> 8);
+}
+
+/**
+ * @brief Calculates the time until the next start of a slot.
+ *
+ * Starts in later frames are extrapolated with the estimated frame length.
+ *
+ * @param[in] slot The slot.
+ * @param[in] now The current time in microseconds.
+ *
+ * @return The time in microseconds, 0 if the slot starts now.
+ */
+unsigned long AsyncTdma::getTimeToSlot(uint8_t slot, unsigned long now) {
+    unsigned long start = this->getSlotStart(slot);
+    long ahead = (long)(start - now);
+    if (ahead >= 0) {
+        return (unsigned long)ahead;
+    }
+
+    unsigned long long past = (unsigned long long)(-ahead) << 8;
+    unsigned long long frames = past / this->period + 1;
+    return (unsigned long)((frames * this->period - past) >> 8);
+}
+
+/**
+ * @brief Calculates the time until the next start of a slot.
+ *
+ * @param[in] slot The slot.
+ *
+ * @return The time in microseconds.
+ */
+unsigned long AsyncTdma::getTimeToSlot(uint8_t slot) {
+    return this->getTimeToSlot(slot, micros());
+}
+
+/**
+ * @brief Retrieves the estimated frame length in local time.
+ *
+ * @return The frame length in microseconds, rounded.
+ */
+unsigned long AsyncTdma::getPeriod() {
+    return (unsigned long)((this->period + 128) >> 8);
+}
+
+/**
+ * @brief Retrieves the estimated drift of the local clock.
+ *
+ * @return The drift in parts per million, positive if the local clock runs
+ * fast.
+ */
+long AsyncTdma::getDrift() {
+    long long nominalQ8 = (long long)this->nominal << 8;
+    return (long)(((long long)this->period - nominalQ8) * 1000000 /
+                  nominalQ8);
+}
+
+/**
+ * @brief Retrieves the number of the current frame.
+ *
+ * @return The frame number.
+ */
+unsigned long AsyncTdma::getFrame() {
+    return this->frame;
+}
+
+/**
+ * @brief Retrieves the number of frames since the last beacon.
+ *
+ * @return The number of missed beacons.
+ */
+unsigned long AsyncTdma::getMissed() {
+    return this->frame - this->beaconFrame;
+}
@@ -0,0 +1,279 @@
+/**
+ * @file AsyncTdma.h
+ *
+ * @brief Provides a TDMA slot scheduler that follows received sync beacons
+ * and corrects the local clock drift between them.
+ *
+ * @author boolscope
+ */
+#ifndef _ASYNC_TDMA_H
+#define _ASYNC_TDMA_H
+
+#include <Arduino.h>
+#include <stdint.h>
+
+#include "AsyncSpscRing.h"
+
+/**
+ * @brief Receives the start of a slot.
+ */
+typedef void (*AsyncSlotFunction)(uint8_t slot);
+
+/**
+ * @class AsyncTdma
+ * @brief Divides the time between two beacons into equal slots and reports
+ * the slot boundaries in microseconds.
+ *
+ * The beacon marks the start of slot 0. Its timestamp is captured in the
+ * receive interrupt with onBeacon() and handed to loop() through an
+ * AsyncSpscRing, so no interrupts need to be disabled. update() consumes the
+ * timestamps and anchors the frame to them exactly, instead of resetting a
+ * millisecond timer.
+ *
+ * The length of a frame in local microseconds is estimated from the
+ * distance between beacons, in 1/256 µs (Q8), with an exponential moving
+ * average (GAIN_SHIFT). Slot boundaries are scaled by the same rate, so a
+ * local clock that runs 0.5% fast still places the last slot of a frame
+ * correctly. Beacons that deviate from the nominal period by more than
+ * 1/2^TOLERANCE_SHIFT are rejected as spurious.
+ *
+ * When beacons are missed, the frame is advanced with the estimated length
+ * (keeping the fraction), until MAX_MISSED frames in a row are missing and
+ * the scheduler loses sync. The first beacon after that resynchronizes it
+ * and keeps the drift estimate.
+ *
+ * Frames are numbered, and poll() fires every (frame, slot) pair at most
+ * once, so a beacon that moves the current frame back a little never
+ * repeats a slot.
+ *
+ * @code
+ * // 100 ms beacon period, 10 slots of 8 ms, 20 ms guard time at the end.
+ * AsyncTdma tdma(100000, 8000, 10);
+ *
+ * void onRadioSync() {  // interrupt handler
+ *   tdma.onBeacon();
+ * }
+ *
+ * void onSlot(uint8_t slot) {
+ *   if (slot == MY_SLOT) {
+ *     radio.transmit(packet);
+ *   }
+ * }
+ *
+ * void setup() {
+ *   tdma.setSlotCallback(onSlot);
+ * }
+ *
+ * void loop() {
+ *   tdma.poll();
+ * }
+ * @endcode
+ */
+class AsyncTdma {
+public:
+    // The weight of a new period measurement, 1/2^GAIN_SHIFT.
+    static const uint8_t GAIN_SHIFT = 3;
+
+    // Beacons off by more than 1/2^TOLERANCE_SHIFT of a period are rejected.
+    static const uint8_t TOLERANCE_SHIFT = 6;
+
+    // The number of frames without a beacon after which sync is lost.
+    static const uint8_t MAX_MISSED = 8;
+
+    // Returned when no slot is active.
+    static const uint8_t NONE = 0xFF;
+
+private:
+    /** @brief Beacon timestamps on their way from the ISR to update(). */
+    AsyncSpscRing<unsigned long, 4> beacons;
+
+    /** @brief The nominal beacon period in microseconds. */
+    unsigned long nominal;
+
+    /** @brief The nominal slot length in microseconds. */
+    unsigned long slotLength;
+
+    /** @brief The number of slots per frame. */
+    uint8_t slots;
+
+    /** @brief The estimated frame length in local 1/256 µs. */
+    unsigned long long period;
+
+    /** @brief The local start of the current frame in microseconds. */
+    unsigned long anchor = 0;
+
+    /** @brief The fraction of the anchor in 1/256 µs. */
+    uint8_t anchorFraction = 0;
+
+    /** @brief The number of the current frame. */
+    unsigned long frame = 0;
+
+    /** @brief The timestamp of the last accepted beacon. */
+    unsigned long lastBeacon = 0;
+
+    /** @brief The frame of the last accepted beacon. */
+    unsigned long beaconFrame = 0;
+
+    /** @brief Set while the frame follows the beacons. */
+    bool synced = false;
+
+    /** @brief The frame of the last slot fired by poll(). */
+    unsigned long firedFrame = 0;
+
+    /** @brief The last slot fired by poll(), NONE before the first. */
+    uint8_t firedSlot = NONE;
+
+    /** @brief Receives the slot starts, may be nullptr. */
+    AsyncSlotFunction slotFunction = nullptr;
+
+    /** @brief Returns the local length of a slot in 1/256 µs. */
+    unsigned long long getLocalSlot();
+
+    /** @brief Anchors the frame to a beacon unless it is rejected. */
+    bool processBeacon(unsigned long timestamp);
+
+public:
+    /** @brief Constructs a new AsyncTdma object.
+     *
+     * The time after the last slot up to the next beacon is a guard time
+     * without an active slot.
+     *
+     * @param[in] beaconPeriod The nominal beacon period in microseconds.
+     * @param[in] slotLength The slot length in microseconds.
+     * @param[in] slots The number of slots per frame, less than NONE.
+     */
+    AsyncTdma(unsigned long beaconPeriod, unsigned long slotLength,
+              uint8_t slots);
+
+    /** @brief Sets the function that is called at every slot start.
+     *
+     * @param[in] fn The function, or nullptr.
+     *
+     * @return void
+     */
+    void setSlotCallback(AsyncSlotFunction fn);
+
+    /** @brief Captures a beacon at the current time. Safe to call from an
+     * interrupt handler.
+     *
+     * @return void
+     */
+    void onBeacon();
+
+    /** @brief Captures a beacon. Safe to call from an interrupt handler.
+     *
+     * @param[in] timestamp The reception time in microseconds, e.g. from an
+     * input capture register.
+     *
+     * @return void
+     */
+    void onBeacon(unsigned long timestamp);
+
+    /** @brief Processes captured beacons and advances the frame.
+     *
+     * @retval true if a beacon was accepted.
+     * @retval false otherwise.
+     */
+    bool update();
+
+    /** @brief Processes captured beacons and advances the frame at the given
+     * time.
+     *
+     * @param[in] now The current time in microseconds.
+     *
+     * @retval true if a beacon was accepted.
+     * @retval false otherwise.
+     */
+    bool update(unsigned long now);
+
+    /** @brief Updates the frame and calls the slot callback if a new slot
+     * has started.
+     *
+     * If poll() is called too rarely to see every slot, the slots in
+     * between are skipped rather than fired late in a burst.
+     *
+     * @return The slot that started, or NONE.
+     */
+    uint8_t poll();
+
+    /** @brief Updates the frame and calls the slot callback if a new slot
+     * has started at the given time.
+     *
+     * @param[in] now The current time in microseconds.
+     *
+     * @return The slot that started, or NONE.
+     */
+    uint8_t poll(unsigned long now);
+
+    /** @brief Checks if the frame follows the beacons.
+     *
+     * @return True while synchronized.
+     */
+    bool isSynced();
+
+    /** @brief Retrieves the active slot.
+     *
+     * @param[in] now The current time in microseconds.
+     *
+     * @return The slot, or NONE if not synchronized or in the guard time.
+     */
+    uint8_t getSlot(unsigned long now);
+
+    /** @brief Retrieves the active slot.
+     *
+     * @return The slot, or NONE if not synchronized or in the guard time.
+     */
+    uint8_t getSlot();
+
+    /** @brief Retrieves the start of a slot in the current frame.
+     *
+     * @param[in] slot The slot.
+     *
+     * @return The local start time in microseconds.
+     */
+    unsigned long getSlotStart(uint8_t slot);
+
+    /** @brief Calculates the time until the next start of a slot.
+     *
+     * @param[in] slot The slot.
+     * @param[in] now The current time in microseconds.
+     *
+     * @return The time in microseconds.
+     */
+    unsigned long getTimeToSlot(uint8_t slot, unsigned long now);
+
+    /** @brief Calculates the time until the next start of a slot.
+     *
+     * @param[in] slot The slot.
+     *
+     * @return The time in microseconds.
+     */
+    unsigned long getTimeToSlot(uint8_t slot);
+
+    /** @brief Retrieves the estimated frame length in local time.
+     *
+     * @return The frame length in microseconds.
+     */
+    unsigned long getPeriod();
+
+    /** @brief Retrieves the estimated drift of the local clock.
+     *
+     * @return The drift in parts per million, positive if the local clock
+     * runs fast.
+     */
+    long getDrift();
+
+    /** @brief Retrieves the number of the current frame.
+     *
+     * @return The frame number.
+     */
+    unsigned long getFrame();
+
+    /** @brief Retrieves the number of frames since the last beacon.
+     *
+     * @return The number of missed beacons.
+     */
+    unsigned long getMissed();
+};
+
+#endif  // _ASYNC_TDMA_H
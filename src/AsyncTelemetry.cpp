@@ -0,0 +1,111 @@
+#include "AsyncTelemetry.h"
+
+/**
+ * @brief Encodes the difference between two counter values.
+ *
+ * The difference is taken modulo 2^32, the receiver accumulates it the same
+ * way.
+ *
+ * @param[in] value The current value.
+ * @param[in] previous The value sent in the previous frame.
+ *
+ * @return The zigzag-encoded difference.
+ */
+static uint32_t delta(unsigned long value, unsigned long previous) {
+    return AsyncTelemetry::zigzag((int32_t)((uint32_t)value -
+                                            (uint32_t)previous));
+}
+
+/**
+ * @brief Constructs a new AsyncTelemetry object.
+ *
+ * The first encoded frame is always a key frame.
+ *
+ * @param[in] scheduler The scheduler whose statistics are serialized.
+ */
+AsyncTelemetry::AsyncTelemetry(AsyncScheduler &scheduler)
+    : scheduler(scheduler) {}
+
+/**
+ * @brief Makes the next frame a key frame.
+ */
+void AsyncTelemetry::reset() {
+    this->keyFrame = true;
+}
+
+/**
+ * @brief Encodes the current statistics into a frame.
+ *
+ * Only occupied slots are written. The buffer size is checked against the
+ * worst case before anything is written, so a failed call does not advance
+ * the sequence number or the delta state.
+ *
+ * @param[out] buffer The buffer receiving the frame.
+ * @param[in] size The size of the buffer in bytes.
+ *
+ * @return The length of the frame, or 0 if the buffer is too small.
+ */
+size_t AsyncTelemetry::encode(uint8_t *buffer, size_t size) {
+    uint8_t count = 0;
+    bool key = this->keyFrame || this->sequence % KEY_FRAME_PERIOD == 0;
+    for (unsigned char i = 0; i < AsyncScheduler::CAPACITY; i++) {
+        if (this->scheduler.getTimer(i) != nullptr) {
+            count++;
+
+            // The receiver learns the name of a new timer from a key frame.
+            if (this->scheduler.getGeneration(i) != this->generations[i]) {
+                key = true;
+            }
+        }
+    }
+
+    if (size < 1 + 2 + 3 + (size_t)count * (1 + 3 + COUNTERS * 5) + 1) {
+        return 0;
+    }
+
+    // The sync byte and the length are written last.
+    size_t n = 3;
+    buffer[n++] = VERSION | (key ? FLAG_KEY_FRAME : 0);
+    buffer[n++] = this->sequence;
+    buffer[n++] = count;
+
+    for (unsigned char i = 0; i < AsyncScheduler::CAPACITY; i++) {
+        if (this->scheduler.getTimer(i) == nullptr) {
+            continue;
+        }
+
+        const AsyncTimerStats &s = this->scheduler.getStats(i);
+        AsyncTimerStats &p = this->previous[i];
+        if (key) {
+            p = AsyncTimerStats();
+        }
+
+        buffer[n++] = i;
+        if (key) {
+            n += writeVarint(buffer + n, this->scheduler.getName(i));
+            this->generations[i] = this->scheduler.getGeneration(i);
+        }
+
+        n += writeVarint(buffer + n, delta(s.fires, p.fires));
+        n += writeVarint(buffer + n, delta(s.missed, p.missed));
+        n += writeVarint(buffer + n, delta(s.maxLateness, p.maxLateness));
+        n += writeVarint(buffer + n, delta(s.callbackTime, p.callbackTime));
+        p = s;
+    }
+
+    size_t length = n - 3;
+    uint8_t checksum = 0;
+    for (size_t i = 3; i < n; i++) {
+        checksum ^= buffer[i];
+    }
+
+    buffer[0] = SYNC;
+    buffer[1] = (uint8_t)(length | 0x80);
+    buffer[2] = (uint8_t)(length >> 7);
+    buffer[n++] = checksum;
+
+    this->sequence++;
+    this->keyFrame = false;
+
+    return n;
+}
@@ -0,0 +1,184 @@
+/**
+ * @file AsyncTelemetry.h
+ *
+ * @brief Provides a compact binary frame format for the per-timer statistics
+ * collected by AsyncScheduler.
+ *
+ * @author boolscope
+ */
+#ifndef _ASYNC_TELEMETRY_H
+#define _ASYNC_TELEMETRY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "AsyncScheduler.h"
+
+/**
+ * @class AsyncTelemetry
+ * @brief Serializes scheduler statistics into delta-encoded binary frames.
+ *
+ * A frame has the following layout, all multi-byte values are unsigned
+ * LEB128 varints:
+ *
+ * @code
+ * SYNC  length  flags  sequence  count
+ *     { slot  name  fires  missed  lateness  cbtime }*  checksum
+ * @endcode
+ *
+ * - `length` is the number of bytes between `length` and `checksum`. It is
+ *   always written as a two-byte varint so it can be filled in last.
+ * - `flags` holds VERSION in the low nibble and FLAG_KEY_FRAME.
+ * - `name` is the name id of the slot (see ASYNC_NAME()). It is only sent
+ *   in key frames; a delta frame keeps the names of the last key frame.
+ * - The four counters are zigzag-encoded differences against the values
+ *   sent in the previous frame; in a key frame they are absolute values.
+ * - `checksum` is the XOR of all bytes between `length` and `checksum`.
+ *
+ * Counters that did not change take a single byte each, so a delta frame
+ * costs about five bytes per timer in steady state. Every
+ * KEY_FRAME_PERIOD-th frame is a key frame, which lets a receiver
+ * resynchronize after a lost frame. A frame is also sent as a key frame
+ * when a slot was given to a new timer since the previous frame, so the
+ * receiver learns its name.
+ *
+ * @code
+ * AsyncTelemetry telemetry(scheduler);
+ * AsyncDelay flushDelay(10000);
+ * uint8_t frame[AsyncTelemetry::MAX_FRAME_SIZE];
+ *
+ * void loop() {
+ *   scheduler.poll();
+ *   if (flushDelay.isReady()) {
+ *     Serial.write(frame, telemetry.encode(frame, sizeof(frame)));
+ *   }
+ * }
+ * @endcode
+ */
+class AsyncTelemetry {
+private:
+    /** @brief The scheduler whose statistics are serialized. */
+    AsyncScheduler &scheduler;
+
+    /** @brief The statistics sent in the previous frame, per slot. */
+    AsyncTimerStats previous[AsyncScheduler::CAPACITY];
+
+    /** @brief The scheduler generation of each slot in the previous frame. */
+    uint8_t generations[AsyncScheduler::CAPACITY] = {};
+
+    /** @brief The sequence number of the next frame. */
+    uint8_t sequence = 0;
+
+    /** @brief Forces the next frame to be a key frame. */
+    bool keyFrame = true;
+
+public:
+    // The first byte of every frame.
+    static const uint8_t SYNC = 0xA5;
+
+    // The frame format version, stored in the low nibble of the flags.
+    static const uint8_t VERSION = 3;
+
+    // Set in the flags byte when the counters are absolute values.
+    static const uint8_t FLAG_KEY_FRAME = 0x80;
+
+    // Every n-th frame is sent as a key frame.
+    static const uint8_t KEY_FRAME_PERIOD = 16;
+
+    // The number of counters sent per timer.
+    static const uint8_t COUNTERS = 4;
+
+    // The largest possible frame size in bytes.
+    static const size_t MAX_FRAME_SIZE =
+        1 + 2 + 3 + AsyncScheduler::CAPACITY * (1 + 3 + COUNTERS * 5) + 1;
+
+    /** @brief Constructs a new AsyncTelemetry object.
+     *
+     * @param[in] scheduler The scheduler whose statistics are serialized.
+     */
+    AsyncTelemetry(AsyncScheduler &scheduler);
+
+    /** @brief Encodes the current statistics into a frame.
+     *
+     * @param[out] buffer The buffer receiving the frame.
+     * @param[in] size The size of the buffer in bytes. MAX_FRAME_SIZE is
+     * always enough.
+     *
+     * @return The length of the frame, or 0 if the buffer is too small. In
+     * the latter case the delta state is left untouched.
+     */
+    size_t encode(uint8_t *buffer, size_t size);
+
+    /** @brief Makes the next frame a key frame.
+     *
+     * Useful when the receiver is known to have lost its state, e.g. after
+     * the link was re-established.
+     *
+     * @return void
+     */
+    void reset();
+
+    /** @brief Writes an unsigned LEB128 varint.
+     *
+     * @param[out] buffer The destination, at least 5 bytes.
+     * @param[in] value The value to write.
+     *
+     * @return The number of bytes written.
+     */
+    static size_t writeVarint(uint8_t *buffer, uint32_t value) {
+        size_t n = 0;
+        while (value >= 0x80) {
+            buffer[n++] = (uint8_t)(value | 0x80);
+            value >>= 7;
+        }
+
+        buffer[n++] = (uint8_t)value;
+        return n;
+    }
+
+    /** @brief Reads an unsigned LEB128 varint.
+     *
+     * @param[in] buffer The source.
+     * @param[in] size The number of readable bytes.
+     * @param[out] value The decoded value.
+     *
+     * @return The number of bytes consumed, or 0 if the varint is truncated
+     * or longer than 5 bytes.
+     */
+    static size_t readVarint(const uint8_t *buffer, size_t size,
+                             uint32_t *value) {
+        uint32_t result = 0;
+        for (size_t n = 0; n < size && n < 5; n++) {
+            result |= (uint32_t)(buffer[n] & 0x7F) << (7 * n);
+            if ((buffer[n] & 0x80) == 0) {
+                *value = result;
+                return n + 1;
+            }
+        }
+
+        return 0;
+    }
+
+    /** @brief Maps a signed difference onto an unsigned value so that small
+     * magnitudes of either sign produce short varints.
+     *
+     * @param[in] value The signed value.
+     *
+     * @return The zigzag-encoded value.
+     */
+    static uint32_t zigzag(int32_t value) {
+        return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+    }
+
+    /** @brief Reverses zigzag().
+     *
+     * @param[in] value The zigzag-encoded value.
+     *
+     * @return The signed value.
+     */
+    static int32_t unzigzag(uint32_t value) {
+        return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+    }
+};
+
+#endif  // _ASYNC_TELEMETRY_H
@@ -0,0 +1,199 @@
+/**
+ * @file AsyncTimerWheel.h
+ *
+ * @brief Provides a hashed timing wheel over externally stored entries.
+ *
+ * @author boolscope
+ */
+#ifndef _ASYNC_TIMER_WHEEL_H
+#define _ASYNC_TIMER_WHEEL_H
+
+#include <stddef.h>
+
+/**
+ * @class AsyncTimerWheel
+ * @brief Keeps deadlines of up to Capacity entries in Slots buckets.
+ *
+ * The wheel does not store any payload: entries are identified by their
+ * index in a pool owned by the user (a TTL table, a retry queue, ...). Every
+ * bucket is an intrusive circular doubly linked list, so schedule(), cancel()
+ * and rescheduling an entry are O(1). A bucket covers `resolution`
+ * milliseconds; deadlines further away than Slots * resolution share the
+ * bucket with nearer ones and are skipped until their round comes.
+ *
+ * pop() advances a cursor through the buckets up to the current time and
+ * returns one due entry per call, so the caller decides how much work is
+ * done per loop iteration. Deadlines are compared with wrapping arithmetic
+ * like AsyncDelay, so they must be less than half the range of unsigned
+ * long away (AsyncDelay::MAX_INTERVAL is).
+ *
+ * @tparam Capacity The number of entries.
+ * @tparam Slots The number of buckets.
+ */
+template <size_t Capacity, size_t Slots = 64>
+class AsyncTimerWheel {
+public:
+    // The index type of entries.
+    typedef size_t Index;
+
+    // Marks the end of a list or "no entry".
+    static const Index NONE = (Index)-1;
+
+private:
+    // The prev link of entries that are not scheduled.
+    static const Index IDLE = (Index)-2;
+
+    // Every bucket is a circular list whose head is a sentinel node with
+    // index Capacity + bucket, so unlinking never needs to know the bucket.
+    static const size_t NODES = Capacity + Slots;
+
+    /** @brief The next node in the same bucket. */
+    Index next[NODES];
+
+    /** @brief The previous node in the same bucket, IDLE if unscheduled. */
+    Index prev[NODES];
+
+    /** @brief The deadline of each entry in milliseconds. */
+    unsigned long deadlines[Capacity];
+
+    /** @brief The time span of one bucket in milliseconds. */
+    unsigned long resolution;
+
+    /** @brief The tick (time / resolution) of the bucket being processed. */
+    unsigned long cursor = 0;
+
+    /** @brief The number of scheduled entries. */
+    size_t count = 0;
+
+    /** @brief Removes a scheduled entry from its bucket. */
+    void unlink(Index i) {
+        this->next[this->prev[i]] = this->next[i];
+        this->prev[this->next[i]] = this->prev[i];
+        this->prev[i] = IDLE;
+        this->count--;
+    }
+
+public:
+    /** @brief Constructs a new AsyncTimerWheel object.
+     *
+     * @param[in] resolution The time span of one bucket in milliseconds.
+     * Defaults to 1.
+     */
+    AsyncTimerWheel(unsigned long resolution = 1)
+        : resolution(resolution == 0 ? 1 : resolution) {
+        for (size_t i = 0; i < Capacity; i++) {
+            this->next[i] = NONE;
+            this->prev[i] = IDLE;
+        }
+
+        for (size_t i = Capacity; i < NODES; i++) {
+            this->next[i] = i;
+            this->prev[i] = i;
+        }
+    }
+
+    /** @brief Schedules an entry, or moves it if it is already scheduled.
+     *
+     * @param[in] i The entry index.
+     * @param[in] deadline The absolute deadline in milliseconds.
+     */
+    void schedule(Index i, unsigned long deadline) {
+        if (this->prev[i] != IDLE) {
+            this->unlink(i);
+        }
+
+        // Overdue entries are linked into the bucket under the cursor.
+        unsigned long tick = deadline / this->resolution;
+        if ((long)(tick - this->cursor) < 0) {
+            tick = this->cursor;
+        }
+
+        Index head = Capacity + tick % Slots;
+        this->deadlines[i] = deadline;
+        this->next[i] = this->next[head];
+        this->prev[i] = head;
+        this->prev[this->next[head]] = i;
+        this->next[head] = i;
+        this->count++;
+    }
+
+    /** @brief Cancels a scheduled entry.
+     *
+     * @param[in] i The entry index.
+     *
+     * @retval true if the entry was scheduled.
+     * @retval false otherwise.
+     */
+    bool cancel(Index i) {
+        if (this->prev[i] == IDLE) {
+            return false;
+        }
+
+        this->unlink(i);
+        return true;
+    }
+
+    /** @brief Checks if an entry is scheduled.
+     *
+     * @param[in] i The entry index.
+     *
+     * @return True if the entry is scheduled.
+     */
+    bool isScheduled(Index i) {
+        return this->prev[i] != IDLE;
+    }
+
+    /** @brief Retrieves the deadline of an entry.
+     *
+     * @param[in] i The entry index.
+     *
+     * @return The deadline passed to the last schedule().
+     */
+    unsigned long getDeadline(Index i) {
+        return this->deadlines[i];
+    }
+
+    /** @brief Returns the number of scheduled entries.
+     *
+     * @return The number of scheduled entries.
+     */
+    size_t size() {
+        return this->count;
+    }
+
+    /** @brief Removes and returns one entry whose deadline has passed.
+     *
+     * Visits at most Slots + 1 buckets per call, even after a long pause or
+     * a millis() rollover.
+     *
+     * @param[in] now The current time in milliseconds.
+     *
+     * @return The index of a due entry, or NONE if no entry is due.
+     */
+    Index pop(unsigned long now) {
+        unsigned long tick = now / this->resolution;
+        if (tick - this->cursor > Slots) {
+            this->cursor = tick - Slots;
+        }
+
+        while (this->count != 0) {
+            Index head = Capacity + this->cursor % Slots;
+            for (Index i = this->next[head]; i != head; i = this->next[i]) {
+                if ((long)(now - this->deadlines[i]) >= 0) {
+                    this->unlink(i);
+                    return i;
+                }
+            }
+
+            if (this->cursor == tick) {
+                break;
+            }
+
+            this->cursor++;
+        }
+
+        return NONE;
+    }
+};
+
+#endif  // _ASYNC_TIMER_WHEEL_H
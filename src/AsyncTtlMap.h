@@ -0,0 +1,374 @@
+/**
+ * @file AsyncTtlMap.h
+ *
+ * @brief Provides a fixed-capacity key/value table whose entries expire
+ * after a period of inactivity.
+ *
+ * @author boolscope
+ */
+#ifndef _ASYNC_TTL_MAP_H
+#define _ASYNC_TTL_MAP_H
+
+#include <Arduino.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "AsyncClock.h"
+#include "AsyncDelay.h"
+#include "AsyncTimerWheel.h"
+
+/**
+ * @brief Default key hash: 32-bit FNV-1a over the bytes of the key.
+ *
+ * Suitable for integers and plain structs without padding. Provide a
+ * specialization or a custom functor for other key types.
+ */
+template <typename K>
+struct AsyncHash {
+    uint32_t operator()(const K &key) const {
+        const uint8_t *p = (const uint8_t *)&key;
+        uint32_t hash = 2166136261UL;
+        for (size_t i = 0; i < sizeof(K); i++) {
+            hash = (hash ^ p[i]) * 16777619UL;
+        }
+
+        return hash;
+    }
+};
+
+/**
+ * @brief Returns the smallest power of two that is not less than n.
+ */
+constexpr size_t asyncNextPow2(size_t n, size_t p = 1) {
+    return p >= n ? p : asyncNextPow2(n, p * 2);
+}
+
+/**
+ * @class AsyncTtlMap
+ * @brief An open-addressing hash table with a timing-wheel expiry index.
+ *
+ * Keys are located through a linear-probing table of entry indices that is
+ * at least twice as large as the capacity; deletions use backward shifting,
+ * so no tombstones accumulate. Every entry with a non-zero TTL is linked
+ * into an AsyncTimerWheel, so touch() extends a TTL in O(1) by moving the
+ * entry to another bucket.
+ *
+ * Expired entries are reclaimed by expire(), which removes at most `budget`
+ * entries per call. Call it from loop() with a small budget and reclamation
+ * is spread over many iterations instead of stopping the world.
+ *
+ * TTLs follow the AsyncDelay interval semantics: they are clamped to
+ * AsyncDelay::MAX_INTERVAL, and a TTL of 0 means the entry never expires
+ * (like a zero interval never becomes ready).
+ *
+ * @code
+ * AsyncTtlMap<uint32_t, Session, 1024> sessions;
+ *
+ * void onPacket(uint32_t device) {
+ *   Session *s = sessions.touch(device);
+ *   if (s == nullptr) {
+ *     s = sessions.insert(device, 60000);
+ *   }
+ * }
+ *
+ * void loop() {
+ *   sessions.expire(8);
+ * }
+ * @endcode
+ *
+ * @tparam K The key type, compared with ==.
+ * @tparam V The value type, default constructible.
+ * @tparam Capacity The maximum number of entries.
+ * @tparam Slots The number of timing-wheel buckets.
+ * @tparam Hash The key hash functor.
+ */
+template <typename K, typename V, size_t Capacity, size_t Slots = 64,
+          typename Hash = AsyncHash<K> >
+class AsyncTtlMap {
+public:
+    /** @brief Called for every entry reclaimed by expire(). */
+    typedef void (*ExpireFunction)(const K &key, V &value);
+
+private:
+    typedef AsyncTimerWheel<Capacity, Slots> Wheel;
+    typedef typename Wheel::Index Index;
+
+    // The size of the probe table, a power of two.
+    static const size_t TABLE_SIZE = asyncNextPow2(2 * Capacity);
+
+    // Marks an empty probe table cell.
+    static const Index EMPTY = Wheel::NONE;
+
+    /** @brief The probe table, holding entry indices. */
+    Index table[TABLE_SIZE];
+
+    /** @brief The probe table cell of each entry. */
+    Index cells[Capacity];
+
+    /** @brief The key of each entry. */
+    K keys[Capacity];
+
+    /** @brief The value of each entry. */
+    V values[Capacity];
+
+    /** @brief The TTL of each entry in milliseconds. */
+    unsigned long ttls[Capacity];
+
+    /** @brief A stack of unused entry indices. */
+    Index freeList[Capacity];
+
+    /** @brief The number of unused entries. */
+    size_t freeCount = Capacity;
+
+    /** @brief The expiry index. */
+    Wheel wheel;
+
+    /** @brief The key hash functor. */
+    Hash hash;
+
+    /** @brief Called for every expired entry, may be nullptr. */
+    ExpireFunction expireFunction = nullptr;
+
+    /** @brief Returns the probe table cell holding the key, or EMPTY. */
+    Index lookup(const K &key) {
+        size_t mask = TABLE_SIZE - 1;
+        for (size_t c = this->hash(key) & mask;; c = (c + 1) & mask) {
+            Index e = this->table[c];
+            if (e == EMPTY) {
+                return EMPTY;
+            }
+
+            if (this->keys[e] == key) {
+                return c;
+            }
+        }
+    }
+
+    /** @brief Removes an entry from the probe table and the wheel, closing
+     * the gap in the probe table. The entry is not freed. */
+    void unlink(Index e) {
+        size_t mask = TABLE_SIZE - 1;
+        size_t hole = this->cells[e];
+        this->table[hole] = EMPTY;
+
+        // Backward-shift deletion: move later entries of the same probe
+        // run into the hole unless that would put them before their home.
+        for (size_t c = (hole + 1) & mask; this->table[c] != EMPTY;
+             c = (c + 1) & mask) {
+            Index moved = this->table[c];
+            size_t home = this->hash(this->keys[moved]) & mask;
+            if (((c - home) & mask) >= ((c - hole) & mask)) {
+                this->table[hole] = moved;
+                this->cells[moved] = hole;
+                this->table[c] = EMPTY;
+                hole = c;
+            }
+        }
+
+        this->wheel.cancel(e);
+    }
+
+    /** @brief Unlinks an entry and returns it to the free list. */
+    void release(Index e) {
+        this->unlink(e);
+        this->freeList[this->freeCount++] = e;
+    }
+
+    /** @brief Schedules the expiry of an entry relative to now. */
+    void arm(Index e, unsigned long now) {
+        if (this->ttls[e] == 0) {
+            this->wheel.cancel(e);
+        } else {
+            this->wheel.schedule(e, now + this->ttls[e]);
+        }
+    }
+
+public:
+    // The maximum number of entries.
+    static const size_t CAPACITY = Capacity;
+
+    /** @brief Constructs a new AsyncTtlMap object.
+     *
+     * @param[in] resolution The expiry resolution in milliseconds (the time
+     * span of one wheel bucket). Defaults to 1.
+     */
+    AsyncTtlMap(unsigned long resolution = 1) : wheel(resolution) {
+        for (size_t c = 0; c < TABLE_SIZE; c++) {
+            this->table[c] = EMPTY;
+        }
+
+        for (size_t i = 0; i < Capacity; i++) {
+            this->freeList[i] = Capacity - 1 - i;
+        }
+    }
+
+    /** @brief Sets the function called for every expired entry.
+     *
+     * When the callback runs, the entry has already been removed from the
+     * map, but its key and value stay valid until the callback returns. The
+     * callback may call any method of the map: find() and erase() no
+     * longer see the expired key, and insert() stores the key again as a
+     * new entry. The expired entry still counts towards the capacity until
+     * the callback returns.
+     *
+     * @param[in] fn The function, or nullptr.
+     */
+    void setExpireCallback(ExpireFunction fn) {
+        this->expireFunction = fn;
+    }
+
+    /** @brief Returns the number of entries.
+     *
+     * @return The number of entries.
+     */
+    size_t size() {
+        return Capacity - this->freeCount;
+    }
+
+    /** @brief Inserts an entry or updates the TTL of an existing one.
+     *
+     * A new entry gets a default-constructed value. In both cases the TTL
+     * starts again at `now`.
+     *
+     * @param[in] key The key.
+     * @param[in] ttl The time to live in milliseconds, 0 = never expires.
+     * @param[in] now The current time in milliseconds.
+     *
+     * @return The value of the entry, or nullptr if the table is full.
+     */
+    V *insert(const K &key, unsigned long ttl, unsigned long now) {
+        Index e;
+        Index c = this->lookup(key);
+        if (c != EMPTY) {
+            e = this->table[c];
+        } else {
+            if (this->freeCount == 0) {
+                return nullptr;
+            }
+
+            e = this->freeList[--this->freeCount];
+            size_t mask = TABLE_SIZE - 1;
+            for (c = this->hash(key) & mask; this->table[c] != EMPTY;
+                 c = (c + 1) & mask) {
+            }
+
+            this->table[c] = e;
+            this->cells[e] = c;
+            this->keys[e] = key;
+            this->values[e] = V();
+        }
+
+        this->ttls[e] =
+            ttl > AsyncDelay::MAX_INTERVAL ? AsyncDelay::MAX_INTERVAL : ttl;
+        this->arm(e, now);
+
+        return &this->values[e];
+    }
+
+    /** @brief Inserts an entry or updates the TTL of an existing one.
+     *
+     * @param[in] key The key.
+     * @param[in] ttl The time to live in milliseconds, 0 = never expires.
+     *
+     * @return The value of the entry, or nullptr if the table is full.
+     */
+    V *insert(const K &key, unsigned long ttl) {
+        return this->insert(key, ttl, AsyncClock::read());
+    }
+
+    /** @brief Looks an entry up without extending its TTL.
+     *
+     * @param[in] key The key.
+     *
+     * @return The value, or nullptr if the key is not present.
+     */
+    V *find(const K &key) {
+        Index c = this->lookup(key);
+        return c == EMPTY ? nullptr : &this->values[this->table[c]];
+    }
+
+    /** @brief Looks an entry up and restarts its TTL at `now`.
+     *
+     * @param[in] key The key.
+     * @param[in] now The current time in milliseconds.
+     *
+     * @return The value, or nullptr if the key is not present.
+     */
+    V *touch(const K &key, unsigned long now) {
+        Index c = this->lookup(key);
+        if (c == EMPTY) {
+            return nullptr;
+        }
+
+        Index e = this->table[c];
+        this->arm(e, now);
+        return &this->values[e];
+    }
+
+    /** @brief Looks an entry up and restarts its TTL.
+     *
+     * @param[in] key The key.
+     *
+     * @return The value, or nullptr if the key is not present.
+     */
+    V *touch(const K &key) {
+        return this->touch(key, AsyncClock::read());
+    }
+
+    /** @brief Removes an entry without calling the expire callback.
+     *
+     * @param[in] key The key.
+     *
+     * @retval true if the key was present.
+     * @retval false otherwise.
+     */
+    bool erase(const K &key) {
+        Index c = this->lookup(key);
+        if (c == EMPTY) {
+            return false;
+        }
+
+        this->release(this->table[c]);
+        return true;
+    }
+
+    /** @brief Reclaims up to `budget` expired entries.
+     *
+     * @param[in] budget The maximum number of entries to reclaim.
+     * @param[in] now The current time in milliseconds.
+     *
+     * @return The number of entries reclaimed.
+     */
+    size_t expire(size_t budget, unsigned long now) {
+        size_t n = 0;
+        for (; n < budget; n++) {
+            Index e = this->wheel.pop(now);
+            if (e == Wheel::NONE) {
+                break;
+            }
+
+            // Unlinked first so the callback cannot find the entry, freed
+            // last so an insert() from the callback cannot reuse it.
+            this->unlink(e);
+            if (this->expireFunction != nullptr) {
+                this->expireFunction(this->keys[e], this->values[e]);
+            }
+
+            this->freeList[this->freeCount++] = e;
+        }
+
+        return n;
+    }
+
+    /** @brief Reclaims up to `budget` expired entries.
+     *
+     * @param[in] budget The maximum number of entries to reclaim.
+     *
+     * @return The number of entries reclaimed.
+     */
+    size_t expire(size_t budget) {
+        return this->expire(budget, AsyncClock::read());
+    }
+};
+
+#endif  // _ASYNC_TTL_MAP_H
@@ -0,0 +1,202 @@
+#include "AsyncWakeStats.h"
+
+#include "AsyncClock.h"
+
+/**
+ * @brief Prints a name id as 0x%04x, the format of the name table.
+ *
+ * @param[in] out The output.
+ * @param[in] name The name id.
+ */
+static void printName(Print &out, uint16_t name) {
+    out.print('0');
+    out.print('x');
+    for (int shift = 12; shift >= 0; shift -= 4) {
+        uint8_t digit = (name >> shift) & 0x0F;
+        out.print((char)(digit < 10 ? '0' + digit : 'a' + digit - 10));
+    }
+}
+
+/**
+ * @brief Constructs a new AsyncWakeStats object.
+ *
+ * @param[in] scheduler The scheduler whose timers wake the system.
+ */
+AsyncWakeStats::AsyncWakeStats(AsyncScheduler &scheduler)
+    : scheduler(scheduler) {}
+
+/**
+ * @brief Records the start of a sleep or idle period.
+ */
+void AsyncWakeStats::recordSleep() {
+    this->recordSleep(AsyncClock::read(), micros());
+}
+
+/**
+ * @brief Records the start of a sleep or idle period at the given time.
+ *
+ * Closes the current awake period and remembers the slot with the earliest
+ * deadline as the cause of the next wakeup.
+ *
+ * @param[in] now The current time in milliseconds.
+ * @param[in] nowUs The current time in microseconds.
+ */
+void AsyncWakeStats::recordSleep(unsigned long now, unsigned long nowUs) {
+    this->sync();
+    if (this->current != NONE) {
+        this->awakeTimes[this->current] += nowUs - this->wakeTime;
+        this->current = NONE;
+    }
+
+    int index = this->scheduler.getEarliest(now);
+    this->pending = index < 0 ? OTHER : (uint8_t)index;
+}
+
+/**
+ * @brief Records the end of a sleep or idle period.
+ */
+void AsyncWakeStats::recordWake() {
+    this->recordWake(micros());
+}
+
+/**
+ * @brief Records the end of a sleep or idle period at the given time.
+ *
+ * @param[in] nowUs The current time in microseconds.
+ */
+void AsyncWakeStats::recordWake(unsigned long nowUs) {
+    this->sync();
+    if (this->pending == NONE) {
+        return;
+    }
+
+    this->wakes[this->pending]++;
+    this->current = this->pending;
+    this->pending = NONE;
+    this->wakeTime = nowUs;
+}
+
+/**
+ * @brief Drops the entries of reused slots, or all entries after
+ * AsyncScheduler::resetStats().
+ *
+ * A reused slot belongs to a new timer, so its wakeups start from zero and
+ * a sleep or awake period of the previous timer is dropped.
+ */
+void AsyncWakeStats::sync() {
+    uint8_t generation = this->scheduler.getStatsGeneration();
+    if (generation != this->statsGeneration) {
+        this->statsGeneration = generation;
+        this->reset();
+    }
+
+    for (uint8_t i = 0; i < AsyncScheduler::CAPACITY; i++) {
+        generation = this->scheduler.getGeneration(i);
+        if (generation == this->generations[i]) {
+            continue;
+        }
+
+        this->generations[i] = generation;
+        this->wakes[i] = 0;
+        this->awakeTimes[i] = 0;
+        if (this->pending == i) {
+            this->pending = NONE;
+        }
+
+        if (this->current == i) {
+            this->current = NONE;
+        }
+    }
+}
+
+/**
+ * @brief Clears all statistics.
+ *
+ * An open awake period is kept, but only counts from now on.
+ */
+void AsyncWakeStats::reset() {
+    for (uint8_t i = 0; i < ENTRIES; i++) {
+        this->wakes[i] = 0;
+        this->awakeTimes[i] = 0;
+    }
+
+    this->wakeTime = micros();
+}
+
+/**
+ * @brief Retrieves the wakeups charged to an entry.
+ *
+ * @param[in] index The slot index or OTHER.
+ *
+ * @return The number of wakeups, 0 for an invalid index.
+ */
+unsigned long AsyncWakeStats::getWakeups(uint8_t index) {
+    this->sync();
+    return index < ENTRIES ? this->wakes[index] : 0;
+}
+
+/**
+ * @brief Retrieves the awake time charged to an entry.
+ *
+ * @param[in] index The slot index or OTHER.
+ *
+ * @return The awake time in milliseconds, 0 for an invalid index.
+ */
+unsigned long AsyncWakeStats::getAwakeTime(uint8_t index) {
+    this->sync();
+    return index < ENTRIES ? (unsigned long)(this->awakeTimes[index] / 1000)
+                           : 0;
+}
+
+/**
+ * @brief Prints the entries ranked by their number of wakeups.
+ *
+ * The entries are ranked with an insertion sort on their indices; there are
+ * only CAPACITY + 1 of them.
+ *
+ * @param[in] out The output.
+ * @param[in] top The maximum number of entries to print.
+ */
+void AsyncWakeStats::report(Print &out, uint8_t top) {
+    this->sync();
+
+    uint8_t order[ENTRIES];
+    for (uint8_t i = 0; i < ENTRIES; i++) {
+        uint8_t j = i;
+        while (j > 0 && this->wakes[order[j - 1]] < this->wakes[i]) {
+            order[j] = order[j - 1];
+            j--;
+        }
+
+        order[j] = i;
+    }
+
+    out.println(F("rank\tslot\tname\twakes\tawake\tavg"));
+
+    for (uint8_t r = 0; r < ENTRIES && r < top; r++) {
+        uint8_t i = order[r];
+        unsigned long n = this->wakes[i];
+        if (n == 0) {
+            break;
+        }
+
+        out.print((unsigned int)(r + 1));
+        out.print('\t');
+        if (i == OTHER) {
+            out.print('-');
+            out.print('\t');
+            out.print('-');
+        } else {
+            out.print((unsigned int)i);
+            out.print('\t');
+            printName(out, this->scheduler.getName(i));
+        }
+
+        out.print('\t');
+        out.print(n);
+        out.print('\t');
+        out.print(this->getAwakeTime(i));
+        out.print('\t');
+        out.println((unsigned long)(this->awakeTimes[i] / n));
+    }
+}
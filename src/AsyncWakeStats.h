@@ -0,0 +1,172 @@
+/**
+ * @file AsyncWakeStats.h
+ *
+ * @brief Provides statistics about which timers wake the system and how
+ * long it stays awake afterwards.
+ *
+ * @author boolscope
+ */
+#ifndef _ASYNC_WAKE_STATS_H
+#define _ASYNC_WAKE_STATS_H
+
+#include <Arduino.h>
+#include <stdint.h>
+
+#include "AsyncScheduler.h"
+
+/**
+ * @class AsyncWakeStats
+ * @brief Attributes every sleep or idle period to the timer whose deadline
+ * ends it.
+ *
+ * recordSleep() is called right before the system sleeps or starts to wait
+ * idle. It asks the scheduler for the slot with the earliest deadline (see
+ * AsyncScheduler::getEarliest()), which is the timer that will wake the
+ * system. recordWake() is called right after the wakeup and charges the
+ * wakeup to that slot. The awake time until the next recordSleep() is
+ * charged to the same slot, so it covers the callback of the waking timer
+ * plus everything else that ran because the system was awake anyway.
+ *
+ * Periods without a running timer, i.e. wakeups by an interrupt only, are
+ * charged to the OTHER entry. The entry of a slot that add() reuses starts
+ * again from zero, and AsyncScheduler::resetStats() clears all entries.
+ *
+ * report() prints the entries ranked by their number of wakeups; the top
+ * entries are the intervals worth lengthening, coalescing or marking
+ * deferrable.
+ *
+ * @code
+ * AsyncWakeStats wakes(scheduler);
+ *
+ * // The enter function of an AsyncPowerManager sleep mode.
+ * void powerDown(unsigned long us) {
+ *   wakes.recordSleep();
+ *   sleepFor(us);
+ *   wakes.recordWake();
+ * }
+ *
+ * void loop() {
+ *   scheduler.poll();
+ *   power.sleep();
+ *
+ *   if (reportDelay.isReady()) {
+ *     wakes.report(Serial, 3);
+ *   }
+ * }
+ * @endcode
+ */
+class AsyncWakeStats {
+public:
+    // The entry for wakeups without a timer deadline.
+    static const uint8_t OTHER = AsyncScheduler::CAPACITY;
+
+    // The number of entries: one per slot plus OTHER.
+    static const uint8_t ENTRIES = OTHER + 1;
+
+private:
+    // Marks that no sleep or awake period is open.
+    static const uint8_t NONE = 0xFF;
+
+    /** @brief The scheduler whose deadlines end the sleep periods. */
+    AsyncScheduler &scheduler;
+
+    /** @brief The number of wakeups charged to each entry. */
+    unsigned long wakes[ENTRIES] = {};
+
+    /** @brief The awake time charged to each entry in microseconds. */
+    unsigned long long awakeTimes[ENTRIES] = {};
+
+    /** @brief The entry that will be charged with the next wakeup. */
+    uint8_t pending = NONE;
+
+    /** @brief The entry the current awake period is charged to. */
+    uint8_t current = NONE;
+
+    /** @brief The time of the last wakeup in microseconds. */
+    unsigned long wakeTime = 0;
+
+    /** @brief The scheduler generation each slot's entry belongs to. */
+    uint8_t generations[AsyncScheduler::CAPACITY] = {};
+
+    /** @brief The scheduler statistics generation of the entries. */
+    uint8_t statsGeneration = 0;
+
+    /** @brief Drops the entries of reused slots, or all entries after
+     * AsyncScheduler::resetStats(). */
+    void sync();
+
+public:
+    /** @brief Constructs a new AsyncWakeStats object.
+     *
+     * @param[in] scheduler The scheduler whose timers wake the system.
+     */
+    AsyncWakeStats(AsyncScheduler &scheduler);
+
+    /** @brief Records the start of a sleep or idle period.
+     *
+     * @return void
+     */
+    void recordSleep();
+
+    /** @brief Records the start of a sleep or idle period at the given time.
+     *
+     * @param[in] now The current time in milliseconds.
+     * @param[in] nowUs The current time in microseconds.
+     *
+     * @return void
+     */
+    void recordSleep(unsigned long now, unsigned long nowUs);
+
+    /** @brief Records the end of a sleep or idle period.
+     *
+     * Does nothing if recordSleep() was not called before.
+     *
+     * @return void
+     */
+    void recordWake();
+
+    /** @brief Records the end of a sleep or idle period at the given time.
+     *
+     * @param[in] nowUs The current time in microseconds.
+     *
+     * @return void
+     */
+    void recordWake(unsigned long nowUs);
+
+    /** @brief Clears all statistics.
+     *
+     * @return void
+     */
+    void reset();
+
+    /** @brief Retrieves the wakeups charged to an entry.
+     *
+     * @param[in] index The slot index or OTHER.
+     *
+     * @return The number of wakeups.
+     */
+    unsigned long getWakeups(uint8_t index);
+
+    /** @brief Retrieves the awake time charged to an entry.
+     *
+     * @param[in] index The slot index or OTHER.
+     *
+     * @return The awake time in milliseconds.
+     */
+    unsigned long getAwakeTime(uint8_t index);
+
+    /** @brief Prints the entries ranked by their number of wakeups.
+     *
+     * One tab-separated line per entry with wakeups: rank, slot (`-` for
+     * OTHER), name id in hex, wakeups, awake time in milliseconds and the
+     * average awake time per wakeup in microseconds.
+     *
+     * @param[in] out The output, e.g. Serial.
+     * @param[in] top The maximum number of entries to print.
+     *
+     * @return void
+     */
+    void report(Print &out, uint8_t top = ENTRIES);
+};
+
+#endif  // _ASYNC_WAKE_STATS_H
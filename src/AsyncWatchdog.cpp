@@ -0,0 +1,80 @@
+#include "AsyncWatchdog.h"
+
+#include <Arduino.h>
+
+#include "AsyncClock.h"
+
+/**
+ * @brief Constructs a new AsyncWatchdog object.
+ *
+ * The timeout starts immediately, as if the watchdog had just been kicked.
+ *
+ * @param[in] timeout The timeout in milliseconds.
+ */
+AsyncWatchdog::AsyncWatchdog(unsigned long timeout) : AsyncDelay(timeout) {}
+
+/**
+ * @brief Restarts the timeout at the time cached by AsyncClock::tick().
+ *
+ * Only the timestamp is stored; the pause state is left untouched.
+ */
+void AsyncWatchdog::kick() {
+    this->kick(AsyncClock::now());
+}
+
+/**
+ * @brief Restarts the timeout at the given time.
+ *
+ * The timestamp only moves forward: a cached time older than the last kick
+ * (or reset) does not shorten the running timeout.
+ *
+ * @param[in] now The current time in milliseconds.
+ */
+void AsyncWatchdog::kick(unsigned long now) {
+    if ((long)(now - this->timestamp) > 0) {
+        this->timestamp = now;
+    }
+
+    this->expired = false;
+}
+
+/**
+ * @brief Checks if the watchdog has been kicked within the timeout.
+ *
+ * @return `true` if the timeout has not passed since the last kick, `false`
+ * if it has or the watchdog is paused.
+ */
+bool AsyncWatchdog::isAlive() {
+    if (this->paused || this->interval == 0) {
+        return false;
+    }
+
+    return !this->expired && this->getDelta() < this->interval;
+}
+
+/**
+ * @brief Reports the expiry of the timeout once.
+ *
+ * @return `true` the first time the timeout passes without a kick.
+ */
+bool AsyncWatchdog::isExpired() {
+    return this->isExpired(AsyncClock::read());
+}
+
+/**
+ * @brief Reports the expiry of the timeout once, at the given time.
+ *
+ * On expiry the count is incremented and the callback, if set, is invoked.
+ *
+ * @param[in] now The current time in milliseconds.
+ *
+ * @return `true` the first time the timeout passes without a kick.
+ */
+bool AsyncWatchdog::isExpired(unsigned long now) {
+    if (this->expired || !this->isDone(now)) {
+        return false;
+    }
+
+    this->expired = true;
+    return true;
+}
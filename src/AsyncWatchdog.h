@@ -0,0 +1,96 @@
+/**
+ * @file AsyncWatchdog.h
+ *
+ * @brief Provides a retriggerable timeout ("expire if not kicked within X").
+ *
+ * @author boolscope
+ */
+#ifndef _ASYNC_WATCHDOG_H
+#define _ASYNC_WATCHDOG_H
+
+#include "AsyncDelay.h"
+
+/**
+ * @class AsyncWatchdog
+ * @brief A retriggerable monostable timer with a constant-time kick.
+ *
+ * kick() only stores AsyncClock::now(), the timestamp cached once per loop
+ * iteration, so it never reads the clock and can be called at any rate.
+ * Because the cached value may be up to one loop iteration old, the timeout
+ * can end at most one loop iteration early.
+ *
+ * isExpired() reports the expiry once: it returns true (and invokes the
+ * callback) the first time the timeout passes without a kick and false
+ * afterwards until the watchdog is kicked again.
+ *
+ * The watchdog is an AsyncDelay, so it can also be registered with an
+ * AsyncScheduler. The scheduler checks the deadline lazily on every poll();
+ * kicks do not touch the scheduler at all. Registered watchdogs fire their
+ * callback once per timeout for as long as the kicks are missing.
+ *
+ * @code
+ * AsyncWatchdog link(3000);
+ *
+ * void loop() {
+ *   AsyncClock::tick();
+ *   if (radio.available()) {
+ *     link.kick();
+ *   }
+ *   if (link.isExpired()) {
+ *     reconnect();
+ *   }
+ * }
+ * @endcode
+ */
+class AsyncWatchdog : public AsyncDelay {
+private:
+    /** @brief Set once the expiry has been reported by isExpired(). */
+    bool expired = false;
+
+public:
+    /** @brief Constructs a new AsyncWatchdog object.
+     *
+     * @param[in] timeout The timeout in milliseconds. Defaults to 0, which
+     * disables the watchdog.
+     */
+    AsyncWatchdog(unsigned long timeout = 0);
+
+    /** @brief Restarts the timeout at the cached loop time.
+     *
+     * @return void
+     */
+    void kick();
+
+    /** @brief Restarts the timeout at the given time.
+     *
+     * @param[in] now The current time in milliseconds.
+     *
+     * @return void
+     */
+    void kick(unsigned long now);
+
+    /** @brief Checks if the watchdog has been kicked within the timeout.
+     *
+     * @retval true if the timeout has not passed since the last kick.
+     * @retval false otherwise, or if the watchdog is paused.
+     */
+    bool isAlive();
+
+    /** @brief Reports the expiry of the timeout once.
+     *
+     * @retval true the first time the timeout passes without a kick.
+     * @retval false otherwise.
+     */
+    bool isExpired();
+
+    /** @brief Reports the expiry of the timeout once, at the given time.
+     *
+     * @param[in] now The current time in milliseconds.
+     *
+     * @retval true the first time the timeout passes without a kick.
+     * @retval false otherwise.
+     */
+    bool isExpired(unsigned long now);
+};
+
+#endif  // _ASYNC_WATCHDOG_H